@@ -0,0 +1,544 @@
+#pragma once
+
+#include "PagedMemory.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <span>
+
+typedef uint32_t Address;
+enum class ACCESS_TYPE : bool
+{
+    WRITE = false,
+    READ = true
+};
+
+// Size in bytes of a single access, usable as a mask
+enum class ACCESS_WIDTH : uint8_t
+{
+    BYTE = 1,
+    HALF = 2,
+    WORD = 4,
+    DOUBLE = 8
+};
+
+constexpr uint8_t ALL_WIDTHS = 1 | 2 | 4 | 8;
+
+// Range of addresses [base, base + size) decoded by a device
+struct AddressWindow
+{
+    Address base;
+    size_t size;
+
+    bool contains(Address address) const
+    {
+        return (address >= base) && (address - base < size);
+    }
+
+    bool contains(Address address, size_t length) const
+    {
+        return contains(address) && (length <= size - (address - base));
+    }
+};
+
+// Atomic read-modify-write operations, to let bus masters implement locks
+enum class ATOMIC_OP
+{
+    SWAP,
+    COMPARE_EXCHANGE,
+    FETCH_ADD
+};
+
+// Single word transaction, used to submit many accesses at once
+struct Request
+{
+    Address address;
+    ACCESS_TYPE type;
+    uint32_t data;
+    bool success {false};
+};
+
+/*
+ * Base of the chain. Once linked, several threads (bus masters) may issue
+ * requests concurrently; setNext() is not thread-safe.
+ */
+class BusHandler
+{
+public:
+    BusHandler() = default;
+    virtual ~BusHandler() = default;
+
+    BusHandler* setNext(BusHandler* n)
+    {
+        next = n;
+        topologyVersion++;
+        return n;
+    }
+
+    BusHandler* getNext() const
+    {
+        return next;
+    }
+
+    // Enables the messages printed when a request is not handled
+    static void setVerbose(bool enabled)
+    {
+        verbose = enabled;
+    }
+
+    static bool isVerbose()
+    {
+        return verbose;
+    }
+
+    // Incremented every time any chain is relinked, to invalidate cached routes
+    static uint64_t getTopologyVersion()
+    {
+        return topologyVersion;
+    }
+
+    virtual bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data)
+    {
+        if (next)
+            return next->handleRequest(address, type, data);
+
+        if (verbose) std::cout << "No device was able to handle the request!" << std::endl;
+        return false;
+    }
+
+    // Block of bytes within a single device, split into word requests by default
+    virtual bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes)
+    {
+        auto w = window();
+        if (w && w->contains(address, bytes.size()))
+            return handleWords(address, type, bytes);
+
+        if (next)
+            return next->handleBurst(address, type, bytes);
+
+        if (verbose) std::cout << "No device was able to handle the burst!" << std::endl;
+        return false;
+    }
+
+    // Executes the requests in order, true if all of them succeeded
+    virtual bool handleBatch(std::span<Request> requests)
+    {
+        bool success = true;
+        for (auto& r : requests)
+        {
+            r.success = handleRequest(r.address, r.type, r.data);
+            success = success && r.success;
+        }
+        return success;
+    }
+
+    // Access of 1, 2, 4 or 8 bytes at any alignment, the value in the low bytes of data
+    virtual bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width)
+    {
+        if (!acceptsWidth(width))
+        {
+            auto w = window();
+            if (w && w->contains(address, static_cast<size_t>(width)))
+                return false; // the device does not serve this width
+        }
+
+        if (width == ACCESS_WIDTH::WORD)
+        {
+            uint32_t word = static_cast<uint32_t>(data);
+            bool success = handleRequest(address, type, word);
+            data = word;
+            return success;
+        }
+
+        auto w = window();
+        if (w && w->contains(address, static_cast<size_t>(width)))
+            return emulateAccess(address, type, data, static_cast<size_t>(width));
+
+        if (next)
+            return next->handleAccess(address, type, data, width);
+
+        if (verbose) std::cout << "No device was able to handle the request!" << std::endl;
+        return false;
+    }
+
+    // Mask of the ACCESS_WIDTH values served by handleAccess()
+    virtual uint8_t accessWidths() const
+    {
+        return ALL_WIDTHS;
+    }
+
+    bool acceptsWidth(ACCESS_WIDTH width) const
+    {
+        return accessWidths() & static_cast<uint8_t>(width);
+    }
+
+    // Atomic operation on an aligned word: data holds the operand and receives the
+    // previous value. COMPARE_EXCHANGE stores data only if the previous value equals expected.
+    virtual bool handleAtomic(Address address, ATOMIC_OP op, uint32_t& data, uint32_t expected = 0)
+    {
+        if (next)
+            return next->handleAtomic(address, op, data, expected);
+
+        if (verbose) std::cout << "No device was able to handle the atomic request!" << std::endl;
+        return false;
+    }
+
+    // Fixed address range of the device, for DecodedBusHandler to route to it directly
+    virtual std::optional<AddressWindow> window() const
+    {
+        return std::nullopt;
+    }
+
+protected:
+    // Applies op to word, returning its previous value
+    static uint32_t applyAtomic(uint32_t& word, ATOMIC_OP op, uint32_t operand, uint32_t expected)
+    {
+        std::atomic_ref<uint32_t> ref(word);
+        switch (op)
+        {
+        case ATOMIC_OP::SWAP:
+            return ref.exchange(operand);
+
+        case ATOMIC_OP::COMPARE_EXCHANGE:
+            ref.compare_exchange_strong(expected, operand); // on failure expected gets the current value
+            return expected;
+
+        case ATOMIC_OP::FETCH_ADD:
+            return ref.fetch_add(operand);
+
+        default:
+            return ref.load();
+        }
+    }
+
+    // Bus data is little endian, as the host
+    static_assert(std::endian::native == std::endian::little);
+
+    static void loadBytes(uint64_t& data, const void* source, size_t length)
+    {
+        data = 0;
+        memcpy(&data, source, length);
+    }
+
+    static void storeBytes(void* destination, uint64_t data, size_t length)
+    {
+        memcpy(destination, &data, length);
+    }
+
+    // Narrow, wide or unaligned access made of read-modify-write word requests
+    bool emulateAccess(Address address, ACCESS_TYPE type, uint64_t& data, size_t length)
+    {
+        Address first = address & ~Address{3};
+        size_t words = ((address + length - 1 - first) / sizeof(uint32_t)) + 1;
+        std::array<uint32_t, 3> buffer {}; // 8 unaligned bytes span at most 3 words
+        auto bytes = reinterpret_cast<uint8_t*>(buffer.data());
+
+        for (size_t i = 0; i < words; ++i)
+            if (!handleRequest(first + i * sizeof(uint32_t), ACCESS_TYPE::READ, buffer[i]))
+                return false;
+
+        if (type == ACCESS_TYPE::READ)
+        {
+            loadBytes(data, bytes + (address - first), length);
+            return true;
+        }
+
+        storeBytes(bytes + (address - first), data, length);
+        for (size_t i = 0; i < words; ++i)
+            if (!handleRequest(first + i * sizeof(uint32_t), ACCESS_TYPE::WRITE, buffer[i]))
+                return false;
+        return true;
+    }
+
+    // Per-word fallback for bursts
+    bool handleWords(Address address, ACCESS_TYPE type, std::span<std::byte> bytes)
+    {
+        if (bytes.size() % sizeof(uint32_t))
+            return false; // only whole words can be split
+
+        for (size_t offset = 0; offset < bytes.size(); offset += sizeof(uint32_t))
+        {
+            uint32_t data = 0;
+            if (type == ACCESS_TYPE::WRITE)
+                memcpy(&data, &bytes[offset], sizeof(data));
+            if (!handleRequest(address + offset, type, data))
+                return false;
+            if (type == ACCESS_TYPE::READ)
+                memcpy(&bytes[offset], &data, sizeof(data));
+        }
+        return true;
+    }
+
+private:
+    BusHandler* next {nullptr};
+    static inline uint64_t topologyVersion {0};
+    static inline bool verbose {true};
+};
+
+class MainMemoryBusHandler : public BusHandler
+{
+public:
+    static constexpr size_t RAM_SIZE = 32 * 1024 * 1024; // 32 MB
+
+    MainMemoryBusHandler(Address start_)
+    : base(start_)
+    {}
+
+    ~MainMemoryBusHandler() = default;
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (AddressWindow{base, RAM_SIZE}.contains(address, sizeof(data)))
+        {
+            size_t offset = address - base;
+            if (offset % sizeof(data))
+            {
+                // unaligned words are not atomic
+                if (type == ACCESS_TYPE::READ)
+                    memcpy(&data, bytes() + offset, sizeof(data));
+                else
+                    memcpy(bytes() + offset, &data, sizeof(data));
+            }
+            else
+            {
+                std::atomic_ref<uint32_t> word(memory[offset / sizeof(data)]);
+                if (type == ACCESS_TYPE::READ)
+                    data = word.load(std::memory_order_acquire);
+                else
+                    word.store(data, std::memory_order_release);
+            }
+            return true;
+        }
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+    bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes) override
+    {
+        if (AddressWindow{base, RAM_SIZE}.contains(address, bytes.size()))
+        {
+            if (type == ACCESS_TYPE::READ)
+                memcpy(bytes.data(), this->bytes() + (address - base), bytes.size());
+            else
+                memcpy(this->bytes() + (address - base), bytes.data(), bytes.size());
+            return true;
+        }
+        return BusHandler::handleBurst(address, type, bytes);
+    }
+
+    bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width) override
+    {
+        size_t length = static_cast<size_t>(width);
+        if (AddressWindow{base, RAM_SIZE}.contains(address, length))
+        {
+            if (width == ACCESS_WIDTH::WORD)
+                return BusHandler::handleAccess(address, type, data, width); // atomic when aligned
+
+            if (type == ACCESS_TYPE::READ)
+                loadBytes(data, bytes() + (address - base), length);
+            else
+                storeBytes(bytes() + (address - base), data, length);
+            return true;
+        }
+        return BusHandler::handleAccess(address, type, data, width);
+    }
+
+    bool handleBatch(std::span<Request> requests) override
+    {
+        bool success = true;
+        for (auto& r : requests)
+        {
+            // qualified call: no virtual dispatch inside the loop
+            r.success = MainMemoryBusHandler::handleRequest(r.address, r.type, r.data);
+            success = success && r.success;
+        }
+        return success;
+    }
+
+    bool handleAtomic(Address address, ATOMIC_OP op, uint32_t& data, uint32_t expected = 0) override
+    {
+        if (AddressWindow{base, RAM_SIZE}.contains(address, sizeof(data)))
+        {
+            if (address % sizeof(data))
+                return false; // atomic operations must be aligned
+
+            data = applyAtomic(memory[(address - base) / sizeof(data)], op, data, expected);
+            return true;
+        }
+        return BusHandler::handleAtomic(address, op, data, expected);
+    }
+
+    std::optional<AddressWindow> window() const override
+    {
+        return AddressWindow{base, RAM_SIZE};
+    }
+
+private:
+    uint8_t* bytes()
+    {
+        return reinterpret_cast<uint8_t*>(memory.data());
+    }
+
+    const Address base;
+    std::array<uint32_t, RAM_SIZE / sizeof(uint32_t)> memory; // stored as words for atomic accesses
+};
+
+class ROMBusHandler : public BusHandler
+{
+public:
+    ROMBusHandler(Address base_, size_t size_) : base(base_), size(size_) {}
+    ~ROMBusHandler() = default;
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (AddressWindow{base, size}.contains(address, sizeof(data)))
+        {
+            if (type == ACCESS_TYPE::READ)
+            {
+                data = static_cast<uint32_t>(read(address - base));
+                return true;
+            }
+            return false; // no write allowed!
+        }
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+    bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width) override
+    {
+        size_t length = static_cast<size_t>(width);
+        if (AddressWindow{base, size}.contains(address, length))
+        {
+            if (type == ACCESS_TYPE::WRITE)
+                return false; // no write allowed!
+
+            data = read(address - base) & (~uint64_t{0} >> (64 - 8 * length));
+            return true;
+        }
+        return BusHandler::handleAccess(address, type, data, width);
+    }
+
+    std::optional<AddressWindow> window() const override
+    {
+        return AddressWindow{base, size};
+    }
+
+private:
+    // The content is the word 0xDA7ADA7A repeated: returns the 8 bytes starting at offset
+    static uint64_t read(size_t offset)
+    {
+        constexpr uint64_t pattern = 0xDA7ADA7ADA7ADA7A;
+        size_t shift = 8 * (offset % sizeof(uint32_t));
+        return shift ? (pattern >> shift) | (pattern << (64 - shift)) : pattern;
+    }
+
+    const Address base;
+    const size_t size;
+};
+
+class FlashMemoryBusHandler : public BusHandler
+{
+public:
+    // Flash memory address is hardcoded
+    static constexpr Address START_ADDRESS = 0x4000;
+    static constexpr Address END_ADDRESS = 0x800000;
+    static constexpr AddressWindow WINDOW{START_ADDRESS, END_ADDRESS - START_ADDRESS};
+    FlashMemoryBusHandler() = default;
+    ~FlashMemoryBusHandler() = default;
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (WINDOW.contains(address, sizeof(data)))
+        {
+            if (address % sizeof(data))
+            {
+                // unaligned words are not atomic
+                if (type == ACCESS_TYPE::WRITE)
+                    memory.write(address, std::as_bytes(std::span(&data, 1)));
+                else
+                    memory.read(address, std::as_writable_bytes(std::span(&data, 1)));
+            }
+            else if (type == ACCESS_TYPE::WRITE)
+                memory.storeWord(address, data);
+            else
+                data = memory.loadWord(address); // never written pages read as zero
+            return true;
+        }
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+    // Flash is programmed by words or double words only
+    bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width) override
+    {
+        size_t length = static_cast<size_t>(width);
+        if (WINDOW.contains(address, length))
+        {
+            if (!acceptsWidth(width))
+                return false;
+            if (width == ACCESS_WIDTH::WORD)
+                return BusHandler::handleAccess(address, type, data, width);
+
+            if (type == ACCESS_TYPE::WRITE)
+                memory.write(address, std::as_bytes(std::span(&data, 1)));
+            else
+                memory.read(address, std::as_writable_bytes(std::span(&data, 1)));
+            return true;
+        }
+        return BusHandler::handleAccess(address, type, data, width);
+    }
+
+    uint8_t accessWidths() const override
+    {
+        return static_cast<uint8_t>(ACCESS_WIDTH::WORD) | static_cast<uint8_t>(ACCESS_WIDTH::DOUBLE);
+    }
+
+    bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes) override
+    {
+        if (WINDOW.contains(address, bytes.size()))
+        {
+            if (type == ACCESS_TYPE::WRITE)
+                memory.write(address, bytes);
+            else
+                memory.read(address, bytes);
+            return true;
+        }
+        return BusHandler::handleBurst(address, type, bytes);
+    }
+
+    bool handleAtomic(Address address, ATOMIC_OP op, uint32_t& data, uint32_t expected = 0) override
+    {
+        if (WINDOW.contains(address, sizeof(data)))
+        {
+            if (address % sizeof(data))
+                return false; // address must be aligned
+
+            data = applyAtomic(memory.word(address), op, data, expected);
+            return true;
+        }
+        return BusHandler::handleAtomic(address, op, data, expected);
+    }
+
+    // Resets [address, address + size) to zero, releasing the whole pages in the range.
+    // No other request may be in flight meanwhile.
+    void erase(Address address, size_t size)
+    {
+        memory.erase(address, size);
+    }
+
+    size_t allocatedBytes() const
+    {
+        return memory.allocatedBytes();
+    }
+
+    std::optional<AddressWindow> window() const override
+    {
+        return WINDOW;
+    }
+
+private:
+    PagedMemory memory;
+};
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "Bus.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+enum class REPLACEMENT
+{
+    LRU,
+    PLRU // tree pseudo-LRU, ways must be a power of two
+};
+
+enum class WRITE_POLICY
+{
+    WRITE_BACK,   // write-allocate, dirty lines written on eviction
+    WRITE_THROUGH // no-write-allocate, every write reaches the next level
+};
+
+struct CacheConfig
+{
+    size_t size {32 * 1024};
+    size_t lineSize {64};
+    size_t ways {8};
+    REPLACEMENT replacement {REPLACEMENT::LRU};
+    WRITE_POLICY writePolicy {WRITE_POLICY::WRITE_BACK};
+    uint64_t hitCycles {4};
+    uint64_t memoryCycles {100}; // cost of a miss when there is no next level
+};
+
+struct CacheStats
+{
+    uint64_t accesses {0};
+    uint64_t hits {0};
+    uint64_t misses {0};
+    uint64_t evictions {0};
+    uint64_t writeBacks {0};
+    uint64_t cycles {0}; // including the time spent in the lower levels
+};
+
+/*
+ * Timing model of a set-associative cache in front of a device: cache.setNext(ram).
+ * Only tags are simulated; a next level given to the constructor sees the misses.
+ */
+class CacheBusHandler : public BusHandler
+{
+public:
+    explicit CacheBusHandler(const CacheConfig& config_, CacheBusHandler* nextLevel_ = nullptr)
+    : config(config_)
+    , nextLevel(nextLevel_)
+    {
+        if (!std::has_single_bit(config.lineSize) || (config.lineSize < sizeof(uint32_t)) || (config.ways == 0)
+            || (config.size % (config.lineSize * config.ways) != 0)
+            || !std::has_single_bit(config.size / (config.lineSize * config.ways)))
+            throw std::runtime_error("Invalid cache geometry!");
+        if ((config.replacement == REPLACEMENT::PLRU) && (!std::has_single_bit(config.ways) || (config.ways > 64)))
+            throw std::runtime_error("Tree PLRU needs a power of two ways, up to 64!");
+
+        lineBits = std::countr_zero(config.lineSize);
+        sets = config.size / (config.lineSize * config.ways);
+        tags.assign(sets * config.ways, INVALID);
+        dirty.assign(sets * config.ways, false);
+        if (config.replacement == REPLACEMENT::LRU)
+            stamps.assign(sets * config.ways, 0);
+        else
+            trees.assign(sets, 0);
+    }
+
+    ~CacheBusHandler() = default;
+
+    // Not through the base class, whose word requests would come back here
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (cacheable(address))
+            access(address, type);
+        if (getNext())
+            return getNext()->handleRequest(address, type, data);
+        return unhandled();
+    }
+
+    bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width) override
+    {
+        if (cacheable(address))
+            accessRange(address, static_cast<size_t>(width), type);
+        if (getNext())
+            return getNext()->handleAccess(address, type, data, width);
+        return unhandled();
+    }
+
+    bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes) override
+    {
+        if (cacheable(address))
+            accessRange(address, bytes.size(), type);
+        if (getNext())
+            return getNext()->handleBurst(address, type, bytes);
+        return unhandled();
+    }
+
+    // Decodes the same addresses as the device behind it
+    std::optional<AddressWindow> window() const override
+    {
+        return getNext() ? getNext()->window() : std::nullopt;
+    }
+
+    // Simulates one access, returning the cycles it takes
+    uint64_t access(Address address, ACCESS_TYPE type)
+    {
+        uint32_t line = address >> lineBits;
+        size_t set = line & (sets - 1);
+        size_t first = set * config.ways;
+        uint64_t cycles = config.hitCycles;
+        stats.accesses++;
+
+        for (size_t way = 0; way < config.ways; ++way)
+        {
+            if (tags[first + way] == line)
+            {
+                stats.hits++;
+                touch(set, way);
+                if (type == ACCESS_TYPE::WRITE)
+                {
+                    if (config.writePolicy == WRITE_POLICY::WRITE_BACK)
+                        dirty[first + way] = true;
+                    else
+                        cycles += lower(address, ACCESS_TYPE::WRITE);
+                }
+                stats.cycles += cycles;
+                return cycles;
+            }
+        }
+
+        stats.misses++;
+        if ((type == ACCESS_TYPE::WRITE) && (config.writePolicy == WRITE_POLICY::WRITE_THROUGH))
+        {
+            cycles += lower(address, ACCESS_TYPE::WRITE);
+            stats.cycles += cycles;
+            return cycles;
+        }
+
+        size_t way = victim(set);
+        if (tags[first + way] != INVALID)
+        {
+            stats.evictions++;
+            if (dirty[first + way])
+            {
+                stats.writeBacks++;
+                cycles += lower(tags[first + way] << lineBits, ACCESS_TYPE::WRITE);
+            }
+        }
+        cycles += lower(address, ACCESS_TYPE::READ); // line fill
+        tags[first + way] = line;
+        dirty[first + way] = (type == ACCESS_TYPE::WRITE);
+        touch(set, way);
+
+        stats.cycles += cycles;
+        return cycles;
+    }
+
+    const CacheStats& getStats() const
+    {
+        return stats;
+    }
+
+    void resetStats()
+    {
+        stats = {};
+    }
+
+private:
+    static constexpr uint32_t INVALID = UINT32_MAX; // never a line number, lines are at least 4 bytes
+
+    static bool unhandled()
+    {
+        if (isVerbose()) std::cout << "No device was able to handle the request!" << std::endl;
+        return false;
+    }
+
+    bool cacheable(Address address)
+    {
+        if (version != getTopologyVersion())
+        {
+            nextWindow = window();
+            version = getTopologyVersion();
+        }
+        return !nextWindow || nextWindow->contains(address);
+    }
+
+    void accessRange(Address address, size_t length, ACCESS_TYPE type)
+    {
+        Address lastLine = static_cast<Address>(address + length - 1) >> lineBits;
+        for (Address line = address >> lineBits; line <= lastLine; ++line)
+            access(std::max(address, line << lineBits), type);
+    }
+
+    uint64_t lower(Address address, ACCESS_TYPE type)
+    {
+        return nextLevel ? nextLevel->access(address, type) : config.memoryCycles;
+    }
+
+    void touch(size_t set, size_t way)
+    {
+        if (config.replacement == REPLACEMENT::LRU)
+        {
+            stamps[set * config.ways + way] = ++clock;
+            return;
+        }
+
+        // every node on the path points away from the way just used
+        uint64_t& tree = trees[set];
+        size_t node = 1;
+        for (size_t bit = config.ways >> 1; bit; bit >>= 1)
+        {
+            bool right = way & bit;
+            if (right)
+                tree &= ~(uint64_t{1} << node);
+            else
+                tree |= uint64_t{1} << node;
+            node = 2 * node + right;
+        }
+    }
+
+    size_t victim(size_t set) const
+    {
+        size_t first = set * config.ways;
+        for (size_t way = 0; way < config.ways; ++way)
+            if (tags[first + way] == INVALID)
+                return way;
+
+        if (config.replacement == REPLACEMENT::LRU)
+        {
+            size_t oldest = 0;
+            for (size_t way = 1; way < config.ways; ++way)
+                if (stamps[first + way] < stamps[first + oldest])
+                    oldest = way;
+            return oldest;
+        }
+
+        // follow the tree bits down to the pseudo least recently used way
+        uint64_t tree = trees[set];
+        size_t node = 1;
+        size_t way = 0;
+        for (size_t bit = config.ways >> 1; bit; bit >>= 1)
+        {
+            bool right = tree & (uint64_t{1} << node);
+            way |= right ? bit : 0;
+            node = 2 * node + right;
+        }
+        return way;
+    }
+
+    const CacheConfig config;
+    CacheBusHandler* const nextLevel;
+    size_t lineBits {0};
+    size_t sets {0};
+
+    std::vector<uint32_t> tags;   // line number per way, INVALID if empty
+    std::vector<bool> dirty;
+    std::vector<uint64_t> stamps; // LRU: last use per way
+    std::vector<uint64_t> trees;  // PLRU: one tree of ways - 1 bits per set
+    uint64_t clock {0};
+
+    CacheStats stats;
+    std::optional<AddressWindow> nextWindow;
+    uint64_t version {UINT64_MAX};
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Bus.h"
+
+#include <array>
+
+/*
+ * Root of the bus caching the windows of the last ENTRIES devices hit, like a TLB.
+ * Not thread-safe: each bus master gets its own, in front of the shared chain.
+ */
+template <size_t ENTRIES = 4>
+class CachedBusHandler : public BusHandler
+{
+public:
+    CachedBusHandler() = default;
+    ~CachedBusHandler() = default;
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (BusHandler* device = route(address))
+            return device->handleRequest(address, type, data);
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+    bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes) override
+    {
+        if (BusHandler* device = route(address))
+            return device->handleBurst(address, type, bytes);
+        return BusHandler::handleBurst(address, type, bytes);
+    }
+
+    bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width) override
+    {
+        if (BusHandler* device = route(address))
+            return device->handleAccess(address, type, data, width);
+        return BusHandler::handleAccess(address, type, data, width);
+    }
+
+    bool handleAtomic(Address address, ATOMIC_OP op, uint32_t& data, uint32_t expected = 0) override
+    {
+        if (BusHandler* device = route(address))
+            return device->handleAtomic(address, op, data, expected);
+        return BusHandler::handleAtomic(address, op, data, expected);
+    }
+
+    void flush()
+    {
+        entries = {};
+        version = getTopologyVersion();
+    }
+
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+
+private:
+    struct Entry
+    {
+        Address base {0};
+        size_t size {0};
+        BusHandler* device {nullptr};
+    };
+
+    // nullptr if the chain must be walked
+    BusHandler* route(Address address)
+    {
+        if (version != getTopologyVersion())
+            flush();
+
+        // most recently used entry first
+        for (size_t i = 0; i < ENTRIES; ++i)
+        {
+            const Entry& e = entries[(lastHit + i) % ENTRIES];
+            if (e.device && (address - e.base < e.size))
+            {
+                hits++;
+                lastHit = (lastHit + i) % ENTRIES;
+                return e.device;
+            }
+        }
+
+        misses++;
+        BusHandler* device = lookup(address);
+        if (device)
+        {
+            auto w = device->window();
+            lastHit = victim;
+            entries[victim] = Entry{w->base, w->size, device};
+            victim = (victim + 1) % ENTRIES;
+        }
+        return device;
+    }
+
+    // The search stops at the first device without a window
+    BusHandler* lookup(Address address) const
+    {
+        for (BusHandler* h = getNext(); h; h = h->getNext())
+        {
+            auto w = h->window();
+            if (!w)
+                return nullptr;
+            if (w->contains(address))
+                return h;
+        }
+        return nullptr;
+    }
+
+    std::array<Entry, ENTRIES> entries {};
+    size_t lastHit {0};
+    size_t victim {0}; // replaced round-robin
+    uint64_t version {getTopologyVersion()};
+    uint64_t hits {0};
+    uint64_t misses {0};
+};
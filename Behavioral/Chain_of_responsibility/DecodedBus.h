@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Bus.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Root of the bus decoding the address: devices declaring an AddressWindow are
+ * found by binary search, the others stay chained as fallback.
+ */
+class DecodedBusHandler : public BusHandler
+{
+public:
+    DecodedBusHandler() = default;
+    ~DecodedBusHandler() = default;
+
+    void map(BusHandler* device)
+    {
+        auto w = device->window();
+        if (!w)
+        {
+            fallbackTail = fallbackTail->setNext(device);
+            return;
+        }
+
+        auto it = std::lower_bound(devices.begin(), devices.end(), w->base,
+                                   [](const Entry& e, Address a) { return e.base < a; });
+        bool overlapsNext = (it != devices.end()) && (it->base - w->base < w->size);
+        bool overlapsPrev = (it != devices.begin()) && (w->base - std::prev(it)->base < std::prev(it)->size);
+        if (overlapsNext || overlapsPrev)
+            throw std::runtime_error("Device address window overlaps an already mapped device!");
+
+        devices.insert(it, Entry{w->base, w->size, device});
+    }
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (const Entry* e = find(address))
+            return e->device->handleRequest(address, type, data);
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+    bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes) override
+    {
+        if (const Entry* e = find(address))
+        {
+            if (AddressWindow{e->base, e->size}.contains(address, bytes.size()))
+                return e->device->handleBurst(address, type, bytes);
+            return handleWords(address, type, bytes); // the burst crosses devices
+        }
+        return BusHandler::handleBurst(address, type, bytes);
+    }
+
+    bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width) override
+    {
+        if (const Entry* e = find(address))
+            return e->device->handleAccess(address, type, data, width);
+        return BusHandler::handleAccess(address, type, data, width);
+    }
+
+    bool handleAtomic(Address address, ATOMIC_OP op, uint32_t& data, uint32_t expected = 0) override
+    {
+        if (const Entry* e = find(address))
+            return e->device->handleAtomic(address, op, data, expected);
+        return BusHandler::handleAtomic(address, op, data, expected);
+    }
+
+    // Consecutive requests hitting the same device are routed once, as a single sub-batch
+    bool handleBatch(std::span<Request> requests) override
+    {
+        bool success = true;
+        size_t i = 0;
+        while (i < requests.size())
+        {
+            const Entry* e = find(requests[i].address);
+            if (!e)
+            {
+                auto& r = requests[i++];
+                r.success = BusHandler::handleRequest(r.address, r.type, r.data);
+                success = success && r.success;
+                continue;
+            }
+
+            size_t j = i + 1;
+            while ((j < requests.size()) && (requests[j].address - e->base < e->size))
+                ++j;
+            success = e->device->handleBatch(requests.subspan(i, j - i)) && success;
+            i = j;
+        }
+        return success;
+    }
+
+private:
+    struct Entry
+    {
+        Address base;
+        size_t size;
+        BusHandler* device;
+    };
+
+    // Mapped device whose window contains address, nullptr if none
+    const Entry* find(Address address) const
+    {
+        auto it = std::upper_bound(devices.begin(), devices.end(), address,
+                                   [](Address a, const Entry& e) { return a < e.base; });
+        if (it != devices.begin())
+        {
+            --it;
+            if (address - it->base < it->size)
+                return &*it;
+        }
+        return nullptr;
+    }
+
+    std::vector<Entry> devices;
+    BusHandler* fallbackTail {this};
+};
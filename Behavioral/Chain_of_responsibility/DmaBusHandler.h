@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Bus.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+enum class DMA_STATUS : uint32_t
+{
+    IDLE = 0,
+    BUSY = 1,
+    DONE = 2,
+    ERROR = 3
+};
+
+/*
+ * DMA controller copying memory in bursts on its own worker thread. Writing START
+ * to CONTROL queues SOURCE, DESTINATION and LENGTH; writing STATUS acknowledges it.
+ */
+class DmaBusHandler : public BusHandler
+{
+public:
+    static constexpr Address SOURCE = 0x0;
+    static constexpr Address DESTINATION = 0x4;
+    static constexpr Address LENGTH = 0x8;
+    static constexpr Address CONTROL = 0xC;
+    static constexpr Address STATUS = 0x10;
+    static constexpr size_t REGISTERS_SIZE = 0x14;
+
+    static constexpr uint32_t START = 1;
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    // bus is where the transfers are performed, usually the root of the chain
+    DmaBusHandler(Address base_, BusHandler& bus_)
+    : base(base_)
+    , bus(bus_)
+    , worker([this](std::stop_token stop) { run(stop); })
+    {}
+
+    ~DmaBusHandler()
+    {
+        {
+            std::lock_guard lock(mutex);
+            worker.request_stop();
+        }
+        wakeUp.notify_all();
+    }
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (!AddressWindow{base, REGISTERS_SIZE}.contains(address, sizeof(data)))
+            return BusHandler::handleRequest(address, type, data);
+        if ((address - base) % sizeof(data))
+            return false; // registers are accessed by aligned words
+
+        std::lock_guard lock(mutex);
+        Address offset = address - base;
+        if (offset == STATUS)
+        {
+            if (type == ACCESS_TYPE::READ)
+                data = static_cast<uint32_t>(status);
+            else if (status != DMA_STATUS::BUSY)
+                status = DMA_STATUS::IDLE;
+            return true;
+        }
+        if (offset == CONTROL)
+        {
+            if (type == ACCESS_TYPE::READ)
+                data = 0;
+            else if (data == START)
+            {
+                queue.push_back(descriptor);
+                status = DMA_STATUS::BUSY;
+                wakeUp.notify_one();
+            }
+            return true;
+        }
+
+        uint32_t& reg = descriptor[offset / sizeof(uint32_t)];
+        if (type == ACCESS_TYPE::READ)
+            data = reg;
+        else
+            reg = data;
+        return true;
+    }
+
+    std::optional<AddressWindow> window() const override
+    {
+        return AddressWindow{base, REGISTERS_SIZE};
+    }
+
+    // Called on the worker thread when the queue drains, with the outcome of the transfers
+    void setCompletionCallback(std::function<void(bool)> callback)
+    {
+        std::lock_guard lock(mutex);
+        onCompletion = std::move(callback);
+    }
+
+    // Blocks until all queued transfers are completed
+    void waitIdle()
+    {
+        std::unique_lock lock(mutex);
+        drained.wait(lock, [this] { return queue.empty() && !transferring; });
+    }
+
+private:
+    typedef std::array<uint32_t, 3> Descriptor; // source, destination, length
+
+    void run(std::stop_token stop)
+    {
+        std::vector<std::byte> buffer(CHUNK_SIZE);
+        bool success = true;
+
+        std::unique_lock lock(mutex);
+        while (true)
+        {
+            wakeUp.wait(lock, [&] { return !queue.empty() || stop.stop_requested(); });
+            if (stop.stop_requested())
+                return;
+
+            Descriptor d = queue.front();
+            queue.pop_front();
+            transferring = true;
+
+            lock.unlock();
+            success = copy(d, buffer) && success;
+            lock.lock();
+
+            if (queue.empty())
+            {
+                status = success ? DMA_STATUS::DONE : DMA_STATUS::ERROR;
+                if (onCompletion)
+                {
+                    // unlocked: the callback may access the registers
+                    auto callback = onCompletion;
+                    lock.unlock();
+                    callback(success);
+                    lock.lock();
+                }
+                success = true;
+            }
+            transferring = false;
+            drained.notify_all();
+        }
+    }
+
+    bool copy(const Descriptor& d, std::vector<std::byte>& buffer)
+    {
+        auto [source, destination, length] = d;
+        for (size_t done = 0; done < length; done += CHUNK_SIZE)
+        {
+            std::span<std::byte> chunk(buffer.data(), std::min<size_t>(CHUNK_SIZE, length - done));
+            if (!bus.handleBurst(static_cast<Address>(source + done), ACCESS_TYPE::READ, chunk)
+                || !bus.handleBurst(static_cast<Address>(destination + done), ACCESS_TYPE::WRITE, chunk))
+                return false;
+        }
+        return true;
+    }
+
+    const Address base;
+    BusHandler& bus;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable drained;
+    Descriptor descriptor {};
+    std::deque<Descriptor> queue;
+    bool transferring {false};
+    DMA_STATUS status {DMA_STATUS::IDLE};
+    std::function<void(bool)> onCompletion;
+
+    std::jthread worker; // last: started once everything else is constructed
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "Bus.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * RAM of any size backed by a private memory mapping (POSIX only), optionally
+ * loaded copy-on-write from a snapshot file that the dirty pages are written back to.
+ */
+class MappedRAMBusHandler : public BusHandler
+{
+public:
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    // Demand-zero memory of the given size
+    MappedRAMBusHandler(Address base_, size_t size_)
+    : base(base_)
+    , size(size_)
+    {
+        if (!windowFits())
+            throw std::runtime_error("RAM does not fit in the address space!");
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::runtime_error("Unable to map RAM!");
+        memory = static_cast<uint8_t*>(p);
+        dirty.resize((pageCount() + 63) / 64);
+    }
+
+    // Memory initialized from a snapshot file, its size is the size of the file
+    MappedRAMBusHandler(Address base_, const std::string& snapshotPath)
+    : base(base_)
+    , snapshot(snapshotPath)
+    {
+        int fd = open(snapshot.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Unable to open snapshot " + snapshot);
+
+        struct stat st;
+        void* p = MAP_FAILED;
+        if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+        {
+            size = static_cast<size_t>(st.st_size);
+            if (windowFits())
+                p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE, fd, 0);
+        }
+        close(fd); // the mapping keeps its own reference to the file
+        if (p == MAP_FAILED)
+            throw std::runtime_error("Unable to map snapshot " + snapshot);
+
+        memory = static_cast<uint8_t*>(p);
+        dirty.resize((pageCount() + 63) / 64);
+    }
+
+    ~MappedRAMBusHandler()
+    {
+        munmap(memory, size);
+    }
+
+    MappedRAMBusHandler(const MappedRAMBusHandler&) = delete;
+    MappedRAMBusHandler& operator=(const MappedRAMBusHandler&) = delete;
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (AddressWindow{base, size}.contains(address, sizeof(data)))
+        {
+            size_t offset = address - base;
+            if (offset % sizeof(data))
+            {
+                access(offset, type, &data, sizeof(data)); // unaligned words are not atomic
+                return true;
+            }
+
+            // aligned: handleAtomic() may update the word meanwhile
+            std::atomic_ref<uint32_t> word(*reinterpret_cast<uint32_t*>(memory + offset));
+            if (type == ACCESS_TYPE::READ)
+                data = word.load(std::memory_order_acquire);
+            else
+            {
+                word.store(data, std::memory_order_release);
+                markDirty(offset, sizeof(data));
+            }
+            return true;
+        }
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+    bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes) override
+    {
+        if (AddressWindow{base, size}.contains(address, bytes.size()))
+        {
+            access(address - base, type, bytes.data(), bytes.size());
+            return true;
+        }
+        return BusHandler::handleBurst(address, type, bytes);
+    }
+
+    bool handleAtomic(Address address, ATOMIC_OP op, uint32_t& data, uint32_t expected = 0) override
+    {
+        if (AddressWindow{base, size}.contains(address, sizeof(data)))
+        {
+            size_t offset = address - base;
+            if (offset % sizeof(data))
+                return false; // atomic operations must be aligned
+
+            uint32_t previous = applyAtomic(*reinterpret_cast<uint32_t*>(memory + offset), op, data, expected);
+            if (op != ATOMIC_OP::COMPARE_EXCHANGE || previous == expected)
+                markDirty(offset, sizeof(data));
+            data = previous;
+            return true;
+        }
+        return BusHandler::handleAtomic(address, op, data, expected);
+    }
+
+    std::optional<AddressWindow> window() const override
+    {
+        return AddressWindow{base, size};
+    }
+
+    // Writes the dirty pages back to the snapshot the memory was loaded from
+    bool writeBack()
+    {
+        if (snapshot.empty())
+            return false;
+
+        int fd = open(snapshot.c_str(), O_WRONLY);
+        if (fd < 0)
+            return false;
+
+        bool success = writePages(fd, false) && (fsync(fd) == 0);
+        close(fd);
+        if (success)
+            std::fill(dirty.begin(), dirty.end(), 0);
+        return success;
+    }
+
+    // Writes the whole memory to a new, sparse, snapshot file
+    bool saveSnapshot(const std::string& path)
+    {
+        if (path == snapshot)
+            return writeBack(); // truncating the mapped file would invalidate the mapping
+
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+
+        bool success = (ftruncate(fd, static_cast<off_t>(size)) == 0)
+                    && writePages(fd, !snapshot.empty())
+                    && (fsync(fd) == 0);
+        close(fd);
+        return success;
+    }
+
+    size_t dirtyPages() const
+    {
+        size_t count = 0;
+        for (auto word : dirty)
+            count += static_cast<size_t>(std::popcount(word));
+        return count;
+    }
+
+private:
+    void access(size_t offset, ACCESS_TYPE type, void* data, size_t length)
+    {
+        if (type == ACCESS_TYPE::READ)
+        {
+            memcpy(data, memory + offset, length);
+            return;
+        }
+
+        memcpy(memory + offset, data, length);
+        markDirty(offset, length);
+    }
+
+    // Atomic: masters writing to pages sharing a bitmap word must not lose bits
+    void markDirty(size_t offset, size_t length)
+    {
+        for (size_t page = offset / PAGE_SIZE; page <= (offset + length - 1) / PAGE_SIZE; ++page)
+            std::atomic_ref<uint64_t>(dirty[page / 64]).fetch_or(uint64_t{1} << (page % 64), std::memory_order_relaxed);
+    }
+
+    // Writes dirty pages, or all of them when allPages is set
+    bool writePages(int fd, bool allPages) const
+    {
+        for (size_t page = 0; page < pageCount(); ++page)
+        {
+            if (!allPages && !(dirty[page / 64] & (uint64_t{1} << (page % 64))))
+                continue;
+
+            size_t offset = page * PAGE_SIZE;
+            size_t length = std::min(PAGE_SIZE, size - offset);
+            if (pwrite(fd, memory + offset, length, static_cast<off_t>(offset)) != static_cast<ssize_t>(length))
+                return false;
+        }
+        return true;
+    }
+
+    size_t pageCount() const
+    {
+        return (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    }
+
+    bool windowFits() const
+    {
+        return (size > 0) && (size - 1 <= uint64_t{UINT32_MAX} - base);
+    }
+
+    const Address base;
+    size_t size {0};
+    uint8_t* memory {nullptr};
+    std::string snapshot;
+    std::vector<uint64_t> dirty; // one bit per page
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+/*
+ * Sparse storage for a 32 bit address space: a two-level page table of 4 KB
+ * pages allocated on first write, unwritten pages read as zero.
+ * Thread-safe, with atomic aligned words; erase() needs exclusive access.
+ */
+class PagedMemory
+{
+public:
+    static constexpr size_t PAGE_BITS = 12;
+    static constexpr size_t PAGE_SIZE = size_t{1} << PAGE_BITS; // 4 KB
+    static constexpr size_t TABLE_BITS = 10;
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_BITS; // pages per table
+    static constexpr size_t DIRECTORY_SIZE = size_t{1} << (32 - PAGE_BITS - TABLE_BITS);
+
+    PagedMemory() = default;
+
+    ~PagedMemory()
+    {
+        for (auto& table : directory)
+        {
+            Table* t = table.load(std::memory_order_relaxed);
+            if (!t)
+                continue;
+            for (auto& page : *t)
+                delete page.load(std::memory_order_relaxed);
+            delete t;
+        }
+    }
+
+    void read(uint32_t address, std::span<std::byte> bytes) const
+    {
+        size_t offset = address & (PAGE_SIZE - 1);
+        if (offset + bytes.size() <= PAGE_SIZE) // fast path: word accesses never cross a page
+        {
+            memcpy(bytes.data(), readPage(address) + offset, bytes.size());
+            return;
+        }
+        forEachPage(address, bytes.size(), [&](uint32_t pageAddress, size_t offset, size_t done, size_t length)
+        {
+            memcpy(bytes.data() + done, readPage(pageAddress) + offset, length);
+        });
+    }
+
+    void write(uint32_t address, std::span<const std::byte> bytes)
+    {
+        forEachPage(address, bytes.size(), [&](uint32_t pageAddress, size_t offset, size_t done, size_t length)
+        {
+            memcpy(writePage(pageAddress) + offset, bytes.data() + done, length);
+        });
+    }
+
+    // Atomic accesses to the word at an aligned address
+    uint32_t loadWord(uint32_t address) const
+    {
+        Page* page = findPage(address);
+        if (!page)
+            return 0;
+        return std::atomic_ref<uint32_t>((*page)[wordIndex(address)]).load(std::memory_order_acquire);
+    }
+
+    void storeWord(uint32_t address, uint32_t value)
+    {
+        std::atomic_ref<uint32_t>(word(address)).store(value, std::memory_order_release);
+    }
+
+    // Word at an aligned address, allocating its page
+    uint32_t& word(uint32_t address)
+    {
+        return (*allocatePage(address))[wordIndex(address)];
+    }
+
+    // Zeroes [address, address + size): whole pages are released, partial ones cleared
+    void erase(uint32_t address, size_t size)
+    {
+        forEachPage(address, size, [&](uint32_t pageAddress, size_t offset, size_t, size_t length)
+        {
+            Table* table = directory[pageAddress >> (PAGE_BITS + TABLE_BITS)].load(std::memory_order_acquire);
+            if (!table)
+                return;
+            auto& slot = (*table)[(pageAddress >> PAGE_BITS) & (TABLE_SIZE - 1)];
+            Page* page = slot.load(std::memory_order_acquire);
+            if (!page)
+                return;
+
+            if (length == PAGE_SIZE)
+            {
+                slot.store(nullptr, std::memory_order_release);
+                delete page;
+                allocatedPages--;
+            }
+            else
+                memset(reinterpret_cast<uint8_t*>(page->data()) + offset, 0, length);
+        });
+    }
+
+    // Heap memory used by tables and pages
+    size_t allocatedBytes() const
+    {
+        return allocatedTables * sizeof(Table) + allocatedPages * sizeof(Page);
+    }
+
+private:
+    typedef std::array<uint32_t, PAGE_SIZE / sizeof(uint32_t)> Page;
+    typedef std::array<std::atomic<Page*>, TABLE_SIZE> Table;
+
+    // Splits [address, address + size) in chunks not crossing page boundaries
+    template <typename FUNC>
+    static void forEachPage(uint32_t address, size_t size, FUNC&& func)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            uint32_t current = static_cast<uint32_t>(address + done);
+            size_t offset = current & (PAGE_SIZE - 1);
+            size_t length = std::min(PAGE_SIZE - offset, size - done);
+            func(current - static_cast<uint32_t>(offset), offset, done, length);
+            done += length;
+        }
+    }
+
+    static size_t wordIndex(uint32_t address)
+    {
+        return (address & (PAGE_SIZE - 1)) / sizeof(uint32_t);
+    }
+
+    Page* findPage(uint32_t address) const
+    {
+        Table* table = directory[address >> (PAGE_BITS + TABLE_BITS)].load(std::memory_order_acquire);
+        if (!table)
+            return nullptr;
+        return (*table)[(address >> PAGE_BITS) & (TABLE_SIZE - 1)].load(std::memory_order_acquire);
+    }
+
+    // Installs a zeroed object in slot unless another thread did it first
+    template <typename T>
+    static T* publish(std::atomic<T*>& slot, std::atomic<size_t>& counter)
+    {
+        T* current = slot.load(std::memory_order_acquire);
+        if (current)
+            return current;
+
+        T* fresh = new T{}; // value-initialized: zeroed
+        if (slot.compare_exchange_strong(current, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            counter++;
+            return fresh;
+        }
+        delete fresh; // lost the race, current holds the winner
+        return current;
+    }
+
+    Page* allocatePage(uint32_t address)
+    {
+        Table* table = publish(directory[address >> (PAGE_BITS + TABLE_BITS)], allocatedTables);
+        return publish((*table)[(address >> PAGE_BITS) & (TABLE_SIZE - 1)], allocatedPages);
+    }
+
+    const uint8_t* readPage(uint32_t address) const
+    {
+        static const Page zeroPage {};
+
+        Page* page = findPage(address);
+        return reinterpret_cast<const uint8_t*>(page ? page->data() : zeroPage.data());
+    }
+
+    uint8_t* writePage(uint32_t address)
+    {
+        return reinterpret_cast<uint8_t*>(allocatePage(address)->data());
+    }
+
+    std::array<std::atomic<Table*>, DIRECTORY_SIZE> directory {};
+    std::atomic<size_t> allocatedTables {0};
+    std::atomic<size_t> allocatedPages {0};
+};
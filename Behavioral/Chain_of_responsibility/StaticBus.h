@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Bus.h"
+
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+
+/*
+ * Bus whose devices are known at compile time, tried in the order given, e.g.
+ * StaticBus<MainMemoryBusHandler, ROMBusHandler, FlashMemoryBusHandler>.
+ */
+template <typename... DEVICES>
+class StaticBus
+{
+public:
+    // Every device must declare its window: it is checked without dispatch
+    explicit StaticBus(DEVICES&... devices_)
+    : devices(devices_...)
+    {
+        if (!(devices_.DEVICES::window() && ...))
+            throw std::runtime_error("Static bus devices must declare their window!");
+    }
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data)
+    {
+        return route(address, sizeof(data), "request", [&]<typename DEVICE>(DEVICE& device)
+        {
+            return device.DEVICE::handleRequest(address, type, data);
+        });
+    }
+
+    bool handleAccess(Address address, ACCESS_TYPE type, uint64_t& data, ACCESS_WIDTH width)
+    {
+        return route(address, static_cast<size_t>(width), "request", [&]<typename DEVICE>(DEVICE& device)
+        {
+            return device.DEVICE::handleAccess(address, type, data, width);
+        });
+    }
+
+    bool handleBurst(Address address, ACCESS_TYPE type, std::span<std::byte> bytes)
+    {
+        return route(address, bytes.size(), "burst", [&]<typename DEVICE>(DEVICE& device)
+        {
+            return device.DEVICE::handleBurst(address, type, bytes);
+        });
+    }
+
+    bool handleBatch(std::span<Request> requests)
+    {
+        bool success = true;
+        for (auto& r : requests)
+        {
+            r.success = handleRequest(r.address, r.type, r.data);
+            success = success && r.success;
+        }
+        return success;
+    }
+
+    bool handleAtomic(Address address, ATOMIC_OP op, uint32_t& data, uint32_t expected = 0)
+    {
+        return route(address, sizeof(data), "atomic request", [&]<typename DEVICE>(DEVICE& device)
+        {
+            return device.DEVICE::handleAtomic(address, op, data, expected);
+        });
+    }
+
+private:
+    // Calls the first device whose window holds [address, address + length)
+    template <typename CALL>
+    bool route(Address address, size_t length, const char* what, CALL call)
+    {
+        bool result = false;
+        bool handled = std::apply([&](auto&... device)
+        {
+            return (dispatch(device, address, length, call, result) || ...);
+        }, devices);
+
+        if (!handled && BusHandler::isVerbose())
+            std::cout << "No device was able to handle the " << what << "!" << std::endl;
+        return result;
+    }
+
+    template <typename DEVICE, typename CALL>
+    static bool dispatch(DEVICE& device, Address address, size_t length, CALL& call, bool& result)
+    {
+        // qualified call: no virtual dispatch
+        if (!device.DEVICE::window()->contains(address, length))
+            return false;
+
+        result = call(device);
+        return true;
+    }
+
+    std::tuple<DEVICES&...> devices;
+};
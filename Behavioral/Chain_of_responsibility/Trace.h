@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Bus.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Binary trace of bus accesses (POSIX only): a TraceHeader followed by
+ * TraceHeader::count fixed-size records, in host byte order.
+ */
+struct TraceHeader
+{
+    static constexpr char MAGIC[8] = {'B', 'U', 'S', 'T', 'R', 'A', 'C', 'E'};
+
+    char magic[8];
+    uint64_t count;
+};
+
+struct TraceRecord
+{
+    Address address;
+    uint32_t data; // written value, ignored for reads
+    ACCESS_TYPE type;
+    uint8_t padding[3] {};
+};
+
+static_assert(sizeof(TraceRecord) == 12);
+
+inline bool writeTrace(const std::string& path, std::span<const TraceRecord> records)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    TraceHeader header{};
+    memcpy(header.magic, TraceHeader::MAGIC, sizeof(header.magic));
+    header.count = records.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size_bytes()));
+    return static_cast<bool>(out);
+}
+
+// Read-only mapping of a trace file: records are used in place, never copied
+class MappedTrace
+{
+public:
+    explicit MappedTrace(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Unable to open trace " + path);
+
+        struct stat st;
+        if ((fstat(fd, &st) == 0) && (static_cast<size_t>(st.st_size) >= sizeof(TraceHeader)))
+        {
+            size = static_cast<size_t>(st.st_size);
+            mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (mapping == MAP_FAILED)
+            throw std::runtime_error("Unable to map trace " + path);
+
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        auto header = static_cast<const TraceHeader*>(mapping);
+        if ((memcmp(header->magic, TraceHeader::MAGIC, sizeof(header->magic)) != 0)
+            || (header->count > (size - sizeof(TraceHeader)) / sizeof(TraceRecord)))
+        {
+            munmap(mapping, size);
+            throw std::runtime_error("Invalid trace " + path);
+        }
+        count = header->count;
+    }
+
+    ~MappedTrace()
+    {
+        munmap(mapping, size);
+    }
+
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    std::span<const TraceRecord> records() const
+    {
+        auto first = reinterpret_cast<const TraceRecord*>(static_cast<const char*>(mapping) + sizeof(TraceHeader));
+        return {first, count};
+    }
+
+private:
+    void* mapping {MAP_FAILED};
+    size_t size {0};
+    size_t count {0};
+};
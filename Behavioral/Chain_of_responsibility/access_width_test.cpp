@@ -0,0 +1,122 @@
+// Checks the accesses of every width at every alignment, native or emulated
+#include "Bus.h"
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Device serving word requests only: other accesses are emulated by the base class
+class RegisterFile : public BusHandler
+{
+public:
+    RegisterFile(Address base_, uint8_t widths_ = ALL_WIDTHS)
+    : base(base_)
+    , widths(widths_)
+    {}
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (AddressWindow{base, sizeof(words)}.contains(address, sizeof(data)))
+        {
+            auto bytes = reinterpret_cast<uint8_t*>(words) + (address - base);
+            if (type == ACCESS_TYPE::READ)
+                memcpy(&data, bytes, sizeof(data));
+            else
+                memcpy(bytes, &data, sizeof(data));
+            return true;
+        }
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+    uint8_t accessWidths() const override
+    {
+        return widths;
+    }
+
+    std::optional<AddressWindow> window() const override
+    {
+        return AddressWindow{base, sizeof(words)};
+    }
+
+    uint32_t words[4] {};
+
+private:
+    const Address base;
+    const uint8_t widths;
+};
+
+int main()
+{
+    BusHandler::setVerbose(false);
+
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr Address RAM_END = RAM_BASE + MainMemoryBusHandler::RAM_SIZE;
+    constexpr Address REGISTERS = 0x100;
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    RegisterFile registers(REGISTERS);
+    BusHandler bus;
+    bus.setNext(&registers)->setNext(ram.get());
+
+    // write 16 known bytes, then read them back with every width and alignment
+    const uint8_t pattern[16] = {0x10, 0x21, 0x32, 0x43, 0x54, 0x65, 0x76, 0x87,
+                                 0x98, 0xA9, 0xBA, 0xCB, 0xDC, 0xED, 0xFE, 0x0F};
+    for (Address base : {REGISTERS, RAM_END - 16})
+    {
+        for (size_t i = 0; i < sizeof(pattern); ++i)
+        {
+            uint64_t value = pattern[i];
+            check(bus.handleAccess(base + i, ACCESS_TYPE::WRITE, value, ACCESS_WIDTH::BYTE), "byte write");
+        }
+
+        bool allRead = true;
+        for (ACCESS_WIDTH width : {ACCESS_WIDTH::BYTE, ACCESS_WIDTH::HALF, ACCESS_WIDTH::WORD, ACCESS_WIDTH::DOUBLE})
+        {
+            size_t length = static_cast<size_t>(width);
+            for (size_t offset = 0; offset + length <= sizeof(pattern); ++offset)
+            {
+                uint64_t value = ~uint64_t{0};
+                uint64_t expected = 0;
+                memcpy(&expected, pattern + offset, length);
+                allRead = allRead && bus.handleAccess(base + offset, ACCESS_TYPE::READ, value, width) && (value == expected);
+            }
+        }
+        check(allRead, "reads of every width and alignment");
+    }
+
+    // unaligned double word write spanning three words, neighbours preserved
+    uint64_t value = 0x0102030405060708;
+    check(bus.handleAccess(REGISTERS + 3, ACCESS_TYPE::WRITE, value, ACCESS_WIDTH::DOUBLE), "unaligned double word write");
+    check((registers.words[0] == 0x08322110) && (registers.words[1] == 0x04050607)
+          && (registers.words[2] == 0xCB010203), "unaligned double word write content");
+
+    check(!bus.handleAccess(REGISTERS + 12, ACCESS_TYPE::READ, value, ACCESS_WIDTH::DOUBLE), "access crossing the end of the registers");
+    check(!bus.handleAccess(RAM_END - 4, ACCESS_TYPE::READ, value, ACCESS_WIDTH::DOUBLE), "access crossing the end of RAM");
+
+    // widths the device does not declare fail in its window, even emulated
+    RegisterFile wordsOnly(REGISTERS, static_cast<uint8_t>(ACCESS_WIDTH::WORD));
+    bus.setNext(&wordsOnly);
+    check(!bus.handleAccess(REGISTERS, ACCESS_TYPE::READ, value, ACCESS_WIDTH::BYTE), "byte access to a word device");
+    check(bus.handleAccess(REGISTERS, ACCESS_TYPE::READ, value, ACCESS_WIDTH::WORD), "word access to a word device");
+
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+    bus.setNext(flash.get());
+    constexpr Address FLASH = FlashMemoryBusHandler::START_ADDRESS;
+    check(!bus.handleAccess(FLASH, ACCESS_TYPE::WRITE, value, ACCESS_WIDTH::HALF), "half word write to flash");
+    check(bus.handleAccess(FLASH + 2, ACCESS_TYPE::WRITE, value, ACCESS_WIDTH::DOUBLE), "unaligned double word write to flash");
+    uint64_t readBack = 0;
+    check(bus.handleAccess(FLASH + 2, ACCESS_TYPE::READ, readBack, ACCESS_WIDTH::DOUBLE) && (readBack == value), "flash read back");
+
+    std::cout << (failures ? "Access width test failed!" : "Access width test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
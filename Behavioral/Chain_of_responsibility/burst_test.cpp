@@ -0,0 +1,78 @@
+// Checks bursts and batches, native or split into word requests
+#include "Bus.h"
+#include "DecodedBus.h"
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    BusHandler::setVerbose(false);
+
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr Address RAM_END = RAM_BASE + MainMemoryBusHandler::RAM_SIZE;
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    ROMBusHandler rom(RAM_END, 0x1000);
+
+    BusHandler chain;
+    chain.setNext(ram.get())->setNext(&rom);
+    DecodedBusHandler decoded;
+    decoded.map(ram.get());
+    decoded.map(&rom);
+
+    std::array<std::byte, 64> block;
+    for (size_t i = 0; i < block.size(); ++i)
+        block[i] = static_cast<std::byte>(i + 1);
+
+    check(chain.handleBurst(RAM_END - block.size(), ACCESS_TYPE::WRITE, block), "burst ending at the end of RAM");
+    std::array<std::byte, 64> readBack {};
+    check(decoded.handleBurst(RAM_END - readBack.size(), ACCESS_TYPE::READ, readBack) && (readBack == block), "burst read back");
+
+    std::array<std::byte, 3> odd {};
+    check(chain.handleBurst(RAM_END - 3, ACCESS_TYPE::READ, odd) && (odd[0] == block[61]), "native burst of any size");
+    check(!chain.handleBurst(RAM_END, ACCESS_TYPE::READ, odd), "split burst of a partial word");
+
+    std::array<std::byte, 8> words {};
+    check(!chain.handleBurst(RAM_END - 4, ACCESS_TYPE::READ, words), "burst crossing devices in the chain");
+    check(decoded.handleBurst(RAM_END - 4, ACCESS_TYPE::READ, words), "burst crossing devices split by the decoded bus");
+    check((words[0] == block[60]) && (words[4] == std::byte{0x7A}), "burst crossing devices content");
+    check(!decoded.handleBurst(RAM_END, ACCESS_TYPE::WRITE, words), "burst write to ROM");
+
+    std::vector<Request> batch
+    {
+        {RAM_BASE, ACCESS_TYPE::WRITE, 0xCAFE},
+        {RAM_BASE + 4, ACCESS_TYPE::WRITE, 0xBEEF},
+        {RAM_END, ACCESS_TYPE::READ, 0},
+        {RAM_END, ACCESS_TYPE::WRITE, 1},
+        {RAM_BASE, ACCESS_TYPE::READ, 0},
+        {0x0, ACCESS_TYPE::READ, 0}
+    };
+    for (BusHandler* bus : {&chain, static_cast<BusHandler*>(&decoded)})
+    {
+        for (auto& r : batch)
+            r.success = !r.success; // every flag must be rewritten by the batch
+        check(!bus->handleBatch(batch), "batch with failing requests");
+        check(batch[0].success && batch[1].success && batch[2].success && batch[4].success, "successful requests of the batch");
+        check(!batch[3].success && !batch[5].success, "failed requests of the batch");
+        check((batch[2].data == 0xDA7ADA7A) && (batch[4].data == 0xCAFE), "data read by the batch");
+        batch[4].data = 0;
+    }
+    check(decoded.handleBatch(std::span<Request>()), "empty batch");
+
+    std::cout << (failures ? "Burst test failed!" : "Burst test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,368 @@
+// Throughput of the bus configurations. Build with -DCMAKE_BUILD_TYPE=Release
+// to get meaningful numbers.
+#include "Bus.h"
+#include "CacheBusHandler.h"
+#include "CachedBus.h"
+#include "DecodedBus.h"
+#include "StaticBus.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Time `count` accesses through `bus` and print the rate
+template <typename BUS>
+void measure(const char* name, BUS& bus, const std::vector<Address>& addresses, size_t count)
+{
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t data = 0;
+        bus.handleRequest(addresses[i % addresses.size()], ACCESS_TYPE::READ, data);
+        checksum += data;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << name << ": " << static_cast<uint64_t>(count / elapsed.count())
+              << " accesses/sec (checksum " << checksum << ")" << std::endl;
+}
+
+// A board with main memory, flash and (devices - 2) ROMs, accessed uniformly at random
+void benchmarkDecodedBus(size_t devices)
+{
+    constexpr Address ROM_BASE = 0x3000000;
+    constexpr size_t ROM_SIZE = 16 * 1024;
+    constexpr Address ROM_STRIDE = 0x10000;
+
+    auto ram = std::make_unique<MainMemoryBusHandler>(0x1000000);
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+    std::vector<std::unique_ptr<ROMBusHandler>> roms;
+    for (size_t i = 0; i < devices - 2; ++i)
+        roms.push_back(std::make_unique<ROMBusHandler>(ROM_BASE + i * ROM_STRIDE, ROM_SIZE));
+
+    BusHandler chain;
+    DecodedBusHandler decoded;
+    CachedBusHandler<> cached;
+    cached.setNext(ram.get());
+    BusHandler* tail = chain.setNext(ram.get());
+    decoded.map(ram.get());
+    for (auto& rom : roms)
+    {
+        tail = tail->setNext(rom.get());
+        decoded.map(rom.get());
+    }
+    tail->setNext(flash.get());
+    decoded.map(flash.get());
+
+    std::mt19937 rng(42);
+    std::vector<BusHandler*> targets{ram.get(), flash.get()};
+    for (auto& rom : roms)
+        targets.push_back(rom.get());
+    std::vector<Address> addresses(1 << 16);
+    for (auto& address : addresses)
+    {
+        auto w = *targets[rng() % targets.size()]->window();
+        address = w.base + (rng() % (w.size / 4 - 1)) * 4;
+    }
+    // local stream: runs of 64 accesses to the same device
+    std::vector<Address> localAddresses(addresses.size());
+    for (size_t i = 0; i < localAddresses.size(); i += 64)
+    {
+        auto w = *targets[rng() % targets.size()]->window();
+        Address start = w.base + (rng() % (w.size / 4 - 65)) * 4;
+        for (size_t j = 0; j < 64; ++j)
+            localAddresses[i + j] = start + j * 4;
+    }
+
+    constexpr size_t ACCESSES = 2'000'000;
+    std::cout << devices << " mapped devices:" << std::endl;
+    measure("linear chain", chain, addresses, ACCESSES);
+    measure("decoded bus ", decoded, addresses, ACCESSES);
+    measure("cached bus  ", cached, addresses, ACCESSES);
+    measure("linear chain, local stream", chain, localAddresses, ACCESSES);
+    measure("cached bus, local stream  ", cached, localAddresses, ACCESSES);
+    std::cout << "  route cache hits: " << cached.getHits() << ", misses: " << cached.getMisses() << std::endl;
+}
+
+// Copy of a firmware image into RAM: word by word, as one burst and as one batch
+void benchmarkBurst()
+{
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr size_t IMAGE_SIZE = 1024 * 1024;
+    constexpr size_t ROUNDS = 50;
+
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    auto rom = std::make_unique<ROMBusHandler>(0x3000000, 16 * 1024);
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+    BusHandler chain;
+    chain.setNext(flash.get())->setNext(rom.get())->setNext(ram.get()); // RAM last: worst case routing
+    DecodedBusHandler decoded;
+    decoded.map(ram.get());
+    decoded.map(rom.get());
+    decoded.map(flash.get());
+
+    std::vector<std::byte> image(IMAGE_SIZE, std::byte{0x5A});
+    std::vector<Request> batch(IMAGE_SIZE / sizeof(uint32_t));
+    for (size_t i = 0; i < batch.size(); ++i)
+        batch[i] = Request{static_cast<Address>(RAM_BASE + i * sizeof(uint32_t)), ACCESS_TYPE::WRITE, 0x5A5A5A5A};
+
+    auto report = [](const char* name, auto&& copy)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < ROUNDS; ++round)
+            copy();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << name << ": " << static_cast<uint64_t>(ROUNDS * IMAGE_SIZE / elapsed.count() / (1024 * 1024))
+                  << " MB/s" << std::endl;
+    };
+
+    std::cout << "Copy of a " << IMAGE_SIZE / 1024 << " KB image into RAM:" << std::endl;
+    report("per-word chain  ", [&]
+    {
+        for (size_t offset = 0; offset < IMAGE_SIZE; offset += sizeof(uint32_t))
+        {
+            uint32_t data;
+            memcpy(&data, &image[offset], sizeof(data));
+            chain.handleRequest(RAM_BASE + offset, ACCESS_TYPE::WRITE, data);
+        }
+    });
+    report("burst chain     ", [&] { chain.handleBurst(RAM_BASE, ACCESS_TYPE::WRITE, image); });
+    report("batch chain     ", [&] { chain.handleBatch(batch); });
+    report("batch decoded   ", [&] { decoded.handleBatch(batch); });
+}
+
+// Static bus against the dynamic chain, replaying the mapped accesses of the demo
+void benchmarkStaticBus()
+{
+    auto ram = std::make_unique<MainMemoryBusHandler>(0x1000000);
+    auto rom = std::make_unique<ROMBusHandler>(0x3000000, 16 * 1024);
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+
+    BusHandler chain;
+    chain.setNext(ram.get())->setNext(rom.get())->setNext(flash.get());
+    StaticBus staticBus(*ram, *rom, *flash);
+
+    std::vector<Address> addresses{0x1000020, 0x1000020, 0x1000022, 0x3000000, 0x3000000, 0x3000008,
+                                   0x6000, 0x71F0, 0x71F4, 0x71F4, 0x71F0};
+
+    constexpr size_t ACCESSES = 20'000'000;
+    std::cout << "Board known at compile time:" << std::endl;
+    measure("dynamic chain", chain, addresses, ACCESSES);
+    measure("static bus   ", staticBus, addresses, ACCESSES);
+}
+
+// Masters on separate threads sharing RAM and flash. Every 64 accesses each
+// master increments a shared counter in RAM, under a spinlock built with CAS.
+void benchmarkConcurrentBus()
+{
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr Address LOCK = RAM_BASE;
+    constexpr Address COUNTER = RAM_BASE + 4;
+    constexpr size_t ACCESSES_PER_THREAD = 2'000'000;
+
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    auto rom = std::make_unique<ROMBusHandler>(0x3000000, 16 * 1024);
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+    DecodedBusHandler bus;
+    bus.map(ram.get());
+    bus.map(rom.get());
+    bus.map(flash.get());
+
+    auto master = [&](unsigned id)
+    {
+        std::mt19937 rng(id);
+        for (size_t i = 0; i < ACCESSES_PER_THREAD; ++i)
+        {
+            if (i % 64 == 0)
+            {
+                uint32_t previous;
+                do
+                {
+                    previous = 1;
+                    bus.handleAtomic(LOCK, ATOMIC_OP::COMPARE_EXCHANGE, previous, 0);
+                } while (previous != 0);
+
+                uint32_t counter;
+                bus.handleRequest(COUNTER, ACCESS_TYPE::READ, counter);
+                counter++;
+                bus.handleRequest(COUNTER, ACCESS_TYPE::WRITE, counter);
+
+                uint32_t unlocked = 0;
+                bus.handleRequest(LOCK, ACCESS_TYPE::WRITE, unlocked);
+                continue;
+            }
+
+            uint32_t r = rng();
+            Address address = (r & 1) ? RAM_BASE + 64 + (r >> 8) % (1024 * 1024) * 4
+                                      : FlashMemoryBusHandler::START_ADDRESS + (r >> 8) % (1024 * 1024) * 4;
+            uint32_t data = r;
+            bus.handleRequest(address, (r & 2) ? ACCESS_TYPE::READ : ACCESS_TYPE::WRITE, data);
+        }
+    };
+
+    std::cout << "Concurrent masters (hardware threads: " << std::thread::hardware_concurrency() << "):" << std::endl;
+    for (unsigned threads : {1, 2, 4, 8, 16})
+    {
+        uint32_t zero = 0;
+        bus.handleRequest(COUNTER, ACCESS_TYPE::WRITE, zero);
+        bus.handleRequest(LOCK, ACCESS_TYPE::WRITE, zero);
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> masters;
+            for (unsigned id = 0; id < threads; ++id)
+                masters.emplace_back(master, id);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        uint32_t counter;
+        bus.handleRequest(COUNTER, ACCESS_TYPE::READ, counter);
+        size_t expected = threads * ((ACCESSES_PER_THREAD + 63) / 64);
+        std::cout << "  " << threads << " threads: " << static_cast<uint64_t>(threads * ACCESSES_PER_THREAD / elapsed.count())
+                  << " accesses/sec, locked counter " << (counter == expected ? "correct" : "WRONG") << std::endl;
+    }
+}
+
+// Speed of the cache model: L1 and L2 in front of RAM
+void benchmarkCacheModel()
+{
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr size_t ACCESSES = 20'000'000;
+
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    std::mt19937 rng(7);
+    std::vector<Address> addresses(1 << 20);
+    for (size_t i = 0; i < addresses.size(); ++i)
+    {
+        // mostly a 64 KB working set, sometimes anywhere in RAM
+        uint32_t r = rng();
+        addresses[i] = RAM_BASE + ((r % 8) ? (r >> 3) % (64 * 1024) : (r >> 3) % (MainMemoryBusHandler::RAM_SIZE - 4)) / 4 * 4;
+    }
+
+    std::cout << "Cache model, L1 32 KB 8-way + L2 256 KB 16-way:" << std::endl;
+    for (auto replacement : {REPLACEMENT::LRU, REPLACEMENT::PLRU})
+    {
+        CacheBusHandler l2(CacheConfig{256 * 1024, 64, 16, replacement, WRITE_POLICY::WRITE_BACK, 12, 200});
+        CacheBusHandler l1(CacheConfig{32 * 1024, 64, 8, replacement, WRITE_POLICY::WRITE_BACK, 4, 200}, &l2);
+        l1.setNext(ram.get());
+
+        measure(replacement == REPLACEMENT::LRU ? "LRU " : "PLRU", l1, addresses, ACCESSES);
+        const CacheStats& s1 = l1.getStats();
+        const CacheStats& s2 = l2.getStats();
+        std::cout << "    L1 hits " << s1.hits << ", misses " << s1.misses << ", evictions " << s1.evictions
+                  << "; L2 hits " << s2.hits << ", misses " << s2.misses
+                  << "; " << static_cast<double>(s1.cycles) / s1.accesses << " cycles/access" << std::endl;
+    }
+}
+
+// Allocator counting the bytes held by a container
+template <typename T>
+struct CountingAllocator
+{
+    typedef T value_type;
+
+    CountingAllocator(size_t& counter_) : counter(&counter_) {}
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : counter(other.counter) {}
+
+    T* allocate(size_t n)
+    {
+        *counter += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        *counter -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(const CountingAllocator& other) const { return counter == other.counter; }
+
+    size_t* counter;
+};
+
+// Fully written 8 MB flash image: paged storage against the former hash map of words
+void benchmarkFlashStorage()
+{
+    constexpr Address START = FlashMemoryBusHandler::START_ADDRESS;
+    constexpr Address END = FlashMemoryBusHandler::END_ADDRESS - sizeof(uint32_t);
+    constexpr size_t ROUNDS = 10;
+
+    auto report = [](const char* name, size_t bytes, auto&& pass)
+    {
+        auto start = std::chrono::steady_clock::now();
+        uint32_t checksum = 0;
+        for (size_t round = 0; round < ROUNDS; ++round)
+            checksum += pass();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << name << ": " << static_cast<uint64_t>(ROUNDS * (END - START) / sizeof(uint32_t) / elapsed.count())
+                  << " reads/sec, " << bytes / 1024 << " KB of heap (checksum " << checksum << ")" << std::endl;
+    };
+
+    std::cout << "Fully written 8 MB flash image:" << std::endl;
+
+    size_t mapBytes = 0;
+    {
+        typedef std::pair<const Address, uint32_t> Entry;
+        std::unordered_map<Address, uint32_t, std::hash<Address>, std::equal_to<Address>, CountingAllocator<Entry>>
+            map(0, std::hash<Address>(), std::equal_to<Address>(), CountingAllocator<Entry>(mapBytes));
+        for (Address a = START; a < END; a += sizeof(uint32_t))
+            map[a] = a;
+        report("hash map    ", mapBytes, [&]
+        {
+            uint32_t sum = 0;
+            for (Address a = START; a < END; a += sizeof(uint32_t))
+            {
+                auto it = map.find(a);
+                sum += (it != map.end()) ? it->second : 0;
+            }
+            return sum;
+        });
+    }
+
+    PagedMemory paged;
+    for (Address a = START; a < END; a += sizeof(uint32_t))
+        paged.write(a, std::as_bytes(std::span(&a, 1)));
+    report("paged memory", paged.allocatedBytes(), [&]
+    {
+        uint32_t sum = 0;
+        for (Address a = START; a < END; a += sizeof(uint32_t))
+        {
+            uint32_t data;
+            paged.read(a, std::as_writable_bytes(std::span(&data, 1)));
+            sum += data;
+        }
+        return sum;
+    });
+    report("paged pages ", paged.allocatedBytes(), [&]
+    {
+        std::array<uint32_t, PagedMemory::PAGE_SIZE / sizeof(uint32_t)> page;
+        uint32_t sum = 0;
+        for (Address a = START; a < END; a += PagedMemory::PAGE_SIZE)
+        {
+            paged.read(a, std::as_writable_bytes(std::span(page)));
+            for (auto word : page)
+                sum += word;
+        }
+        return sum;
+    });
+}
+
+int main()
+{
+    for (size_t devices : {3, 30, 300})
+        benchmarkDecodedBus(devices);
+    benchmarkStaticBus();
+    benchmarkBurst();
+    benchmarkFlashStorage();
+    benchmarkConcurrentBus();
+    benchmarkCacheModel();
+}
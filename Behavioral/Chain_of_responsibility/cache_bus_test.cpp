@@ -0,0 +1,84 @@
+// Checks the accesses the cache model counts for each kind of request
+#include "Bus.h"
+#include "CacheBusHandler.h"
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+void checkStats(const CacheBusHandler& cache, uint64_t accesses, uint64_t misses, const char* what)
+{
+    const CacheStats& stats = cache.getStats();
+    if ((stats.accesses != accesses) || (stats.misses != misses))
+    {
+        std::cout << "FAILED: " << what << ": " << stats.accesses << " accesses, " << stats.misses
+                  << " misses instead of " << accesses << ", " << misses << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    constexpr Address RAM_BASE = 0x1000000;
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    CacheBusHandler cache(CacheConfig{});
+    cache.setNext(ram.get());
+
+    uint64_t value = 0xCAFE;
+    check(cache.handleAccess(RAM_BASE, ACCESS_TYPE::WRITE, value, ACCESS_WIDTH::WORD), "word access");
+    checkStats(cache, 1, 1, "word access");
+
+    uint32_t word = 0;
+    check(cache.handleRequest(RAM_BASE, ACCESS_TYPE::READ, word) && (word == 0xCAFE), "word request");
+    checkStats(cache, 2, 1, "word request on the same line");
+
+    value = 0xAB;
+    check(cache.handleAccess(RAM_BASE + 0x101, ACCESS_TYPE::WRITE, value, ACCESS_WIDTH::BYTE), "byte access");
+    checkStats(cache, 3, 2, "byte access");
+
+    // 4 lines of 64 bytes, served by the RAM in one piece
+    std::array<std::byte, 256> burst;
+    for (size_t i = 0; i < burst.size(); ++i)
+        burst[i] = static_cast<std::byte>(i);
+    check(cache.handleBurst(RAM_BASE + 0x1000, ACCESS_TYPE::WRITE, burst), "burst write");
+    checkStats(cache, 7, 6, "burst write");
+
+    std::array<std::byte, 256> readBack {};
+    check(cache.handleBurst(RAM_BASE + 0x1000, ACCESS_TYPE::READ, readBack) && (readBack == burst), "burst read");
+    checkStats(cache, 11, 6, "burst read of cached lines");
+
+    // unaligned access spanning two lines
+    value = 0;
+    check(cache.handleAccess(RAM_BASE + 0x2000 - 4, ACCESS_TYPE::READ, value, ACCESS_WIDTH::DOUBLE), "line crossing access");
+    checkStats(cache, 13, 8, "line crossing access");
+
+    for (size_t lineSize : {1, 2})
+    {
+        bool rejected = false;
+        try
+        {
+            CacheBusHandler invalid(CacheConfig{32 * 1024, lineSize, 8});
+        }
+        catch (const std::runtime_error&)
+        {
+            rejected = true;
+        }
+        check(rejected, "lines smaller than a word rejected");
+    }
+
+    std::cout << (failures ? "Cache bus test failed!" : "Cache bus test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
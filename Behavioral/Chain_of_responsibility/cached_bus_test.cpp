@@ -0,0 +1,83 @@
+// Checks the routes remembered by the cached bus
+#include "Bus.h"
+#include "CachedBus.h"
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+template <size_t ENTRIES>
+void checkCounts(const CachedBusHandler<ENTRIES>& bus, uint64_t hits, uint64_t misses, const char* what)
+{
+    if ((bus.getHits() != hits) || (bus.getMisses() != misses))
+    {
+        std::cout << "FAILED: " << what << ": " << bus.getHits() << " hits, " << bus.getMisses()
+                  << " misses instead of " << hits << ", " << misses << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    BusHandler::setVerbose(false);
+
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr Address RAM_END = RAM_BASE + MainMemoryBusHandler::RAM_SIZE;
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    ROMBusHandler rom(0x0, 0x1000);
+    ROMBusHandler highRom(RAM_END, 0x1000);
+
+    CachedBusHandler<2> bus;
+    bus.setNext(ram.get())->setNext(&rom)->setNext(&highRom);
+
+    uint32_t data = 0xCAFE;
+    check(bus.handleRequest(RAM_BASE, ACCESS_TYPE::WRITE, data), "first word of RAM");
+    checkCounts(bus, 0, 1, "first access");
+    check(bus.handleRequest(RAM_END - 4, ACCESS_TYPE::READ, data), "last word of RAM");
+    checkCounts(bus, 1, 1, "same window");
+    check(bus.handleRequest(RAM_END, ACCESS_TYPE::READ, data) && (data == 0xDA7ADA7A), "first word after RAM");
+    checkCounts(bus, 1, 2, "adjacent window");
+    check(!bus.handleRequest(RAM_END - 2, ACCESS_TYPE::READ, data), "word crossing the end of RAM");
+
+    // a third window evicts the oldest entry
+    check(bus.handleRequest(0x0, ACCESS_TYPE::READ, data), "ROM");
+    checkCounts(bus, 2, 3, "third window");
+    bus.handleRequest(RAM_BASE, ACCESS_TYPE::READ, data);
+    checkCounts(bus, 2, 4, "evicted window");
+    check(data == 0xCAFE, "RAM read back");
+
+    uint64_t value = 0;
+    check(bus.handleAccess(RAM_BASE, ACCESS_TYPE::READ, value, ACCESS_WIDTH::BYTE) && (value == 0xFE), "access");
+    data = 1;
+    check(bus.handleAtomic(RAM_BASE, ATOMIC_OP::FETCH_ADD, data) && (data == 0xCAFE), "atomic");
+    std::array<std::byte, 8> bytes {};
+    check(bus.handleBurst(RAM_BASE, ACCESS_TYPE::READ, bytes) && (bytes[0] == std::byte{0xFF}), "burst");
+    checkCounts(bus, 5, 4, "every kind of request is routed");
+
+    // relinking flushes the routes
+    bus.setNext(&rom);
+    check(!bus.handleRequest(RAM_BASE, ACCESS_TYPE::READ, data), "unlinked RAM");
+    checkCounts(bus, 5, 5, "relinked chain");
+
+    // the walk stops at a device without a window
+    BusHandler anyDevice;
+    bus.setNext(&anyDevice)->setNext(ram.get());
+    check(bus.handleRequest(RAM_BASE, ACCESS_TYPE::READ, data) && (data == 0xCAFF), "device after one without window");
+    check(bus.handleRequest(RAM_BASE, ACCESS_TYPE::READ, data), "device after one without window again");
+    checkCounts(bus, 5, 7, "device without window is never cached");
+
+    std::cout << (failures ? "Cached bus test failed!" : "Cached bus test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -1,134 +1,39 @@
+#include "Bus.h"
+#include "CachedBus.h"
+#include "DecodedBus.h"
+#include "DmaBusHandler.h"
+#include "StaticBus.h"
+
 #include <array>
-#include <cstring>
-#include <memory>
+#include <cstddef>
 #include <iostream>
+#include <memory>
 #include <tuple>
-#include <unordered_map>
 #include <vector>
 
-typedef uint32_t Address;
-enum class ACCESS_TYPE : bool
-{
-    WRITE = false,
-    READ = true
-};
+typedef std::vector<std::tuple<Address, ACCESS_TYPE, uint32_t>> AccessList;
 
-class BusHandler
+template <typename BUS>
+void runAccesses(BUS& bus, const AccessList& accesses)
 {
-public:
-    BusHandler() = default;
-    virtual ~BusHandler() = default;
-
-    BusHandler* setNext(BusHandler* n)
-    {
-        next = n;
-        return n;
-    }
-
-    virtual bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data)
-    {
-        if (next)
-            return next->handleRequest(address, type, data);
-
-        if (verbose) std::cout << "No device was able to handle the request!" << std::endl;
-        return false;
-    }
-
-private:
-    BusHandler* next {nullptr};
-    static constexpr bool verbose = true;
-};
-
-class MainMemoryBusHandler : public BusHandler
-{
-public:
-    static constexpr size_t RAM_SIZE = 32 * 1024 * 1024; // 32 MB
-
-    MainMemoryBusHandler(Address start_)
-    : base(start_)
-    {}
-
-    ~MainMemoryBusHandler() = default;
-
-    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    for (const auto& acc : accesses)
     {
-        if ((address >= base) && (address < base + RAM_SIZE - sizeof(data)))
+        auto [addr, type, data] = acc;
+        bool success = bus.handleRequest(addr, type, data);
+        if (success)
         {
+            std::cout << "Success! ";
             if (type == ACCESS_TYPE::READ)
-                memcpy(&data, &memory[address - base], sizeof(data));
+                std::cout << "Read 0x" << std::hex << data << " at address 0x" << std::hex << addr << std::endl;
             else
-                memcpy(&memory[address - base], &data, sizeof(data));
-            return true;
-        }
-        return BusHandler::handleRequest(address, type, data);
-    }
-private:
-    const Address base;
-    std::array<uint8_t, RAM_SIZE> memory;
-};
-
-class ROMBusHandler : public BusHandler
-{
-public:
-    ROMBusHandler(Address base_, size_t size_) : base(base_), size(size_) {}
-    ~ROMBusHandler() = default;
-
-    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
-    {
-        if ((address >= base) && (address < base + size - sizeof(data)))
-        {
-            if (type == ACCESS_TYPE::READ)
-            {
-                // actual memory access
-                data = 0xDA7ADA7A;
-                return true;
-            }
-            return false; // no write allowed!
+                std::cout << "Write 0x" << std::hex << data << " at address 0x" << std::hex << addr << std::endl;
         }
-        return BusHandler::handleRequest(address, type, data);
-    }
-
-private:
-    const Address base;
-    const size_t size;
-};
-
-class FlashMemoryBusHandler : public BusHandler
-{
-public:
-    // Flash memory address is hardcoded
-    static constexpr Address START_ADDRESS = 0x4000;
-    static constexpr Address END_ADDRESS = 0x800000;
-    FlashMemoryBusHandler() = default;
-    ~FlashMemoryBusHandler() = default;
-
-    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
-    {
-        if ((address >= START_ADDRESS) && (address < END_ADDRESS - sizeof(data)))
+        else
         {
-            if (address % sizeof(data))
-                return false; // address must be aligned
-            else
-            {
-                if (type == ACCESS_TYPE::WRITE)
-                    memory[address] = data;
-                else
-                {
-                    if (memory.contains(address))
-                        data = memory[address];
-                    else
-                        data = 0; // memory has been zeroed
-                }
-                return true;
-            }
+            std::cout << "Failed!" << std::endl;
         }
-        return BusHandler::handleRequest(address, type, data);
     }
-
-private:
-    std::unordered_map<Address, uint32_t> memory;
-};
-
+}
 
 int main(int argc, const char* argv[])
 {
@@ -139,7 +44,7 @@ int main(int argc, const char* argv[])
     auto bus = std::make_unique<BusHandler>();
     bus->setNext(ram.get())->setNext(rom.get())->setNext(flash.get());
 
-    std::vector<std::tuple<Address, ACCESS_TYPE, uint32_t>> accesses
+    AccessList accesses
     {
         {0x120, ACCESS_TYPE::WRITE, 0},
 
@@ -159,21 +64,99 @@ int main(int argc, const char* argv[])
         {0x71F0, ACCESS_TYPE::READ, 0 /*dummy*/}
     };
 
-    for (const auto& acc : accesses)
+    std::cout << "Linear chain:" << std::endl;
+    runAccesses(*bus, accesses);
+
+    // Same devices, but the bus decodes the address and dispatches directly
+    auto decodedBus = std::make_unique<DecodedBusHandler>();
+    decodedBus->map(ram.get());
+    decodedBus->map(rom.get());
+    decodedBus->map(flash.get());
+
+    std::cout << "\nDecoded bus:" << std::endl;
+    runAccesses(*decodedBus, accesses);
+
+    // Same chain, with a route cache in front of it
+    auto cachedBus = std::make_unique<CachedBusHandler<>>();
+    cachedBus->setNext(ram.get());
+
+    std::cout << "\nCached bus:" << std::endl;
+    runAccesses(*cachedBus, accesses);
+    std::cout << std::dec << "Route cache hits: " << cachedBus->getHits() << ", misses: " << cachedBus->getMisses() << std::endl;
+
+    // Same devices, composed at compile time
+    StaticBus staticBus(*ram, *rom, *flash);
+
+    std::cout << "\nStatic bus:" << std::endl;
+    runAccesses(staticBus, accesses);
+
+    // Accesses of any width and alignment, each one served in a single request
+    std::vector<std::tuple<Address, ACCESS_TYPE, uint64_t, ACCESS_WIDTH>> sizedAccesses
     {
-        auto [addr, type, data] = acc;
-        bool success = bus->handleRequest(addr, type, data);
-        if (success)
-        {
-            std::cout << "Success! ";
-            if (type == ACCESS_TYPE::READ)
-                std::cout << "Read 0x" << std::hex << data << " at address 0x" << std::hex << addr << std::endl;
-            else
-                std::cout << "Write 0x" << std::hex << data << " at address 0x" << std::hex << addr << std::endl;
-        }
-        else
-        {
-            std::cout << "Failed!" << std::endl;
-        }
+        {0x1000031, ACCESS_TYPE::WRITE, 0xAB, ACCESS_WIDTH::BYTE},
+        {0x1000033, ACCESS_TYPE::WRITE, 0x1122334455667788, ACCESS_WIDTH::DOUBLE},
+        {0x1000030, ACCESS_TYPE::READ, 0 /*dummy*/, ACCESS_WIDTH::HALF},
+        {0x1000034, ACCESS_TYPE::READ, 0 /*dummy*/, ACCESS_WIDTH::DOUBLE},
+        {0x2FFFFFC, ACCESS_TYPE::READ, 0 /*dummy*/, ACCESS_WIDTH::WORD}, // last word of RAM
+        {0x2FFFFFE, ACCESS_TYPE::READ, 0 /*dummy*/, ACCESS_WIDTH::WORD}, // crosses the end of RAM
+        {0x3000001, ACCESS_TYPE::READ, 0 /*dummy*/, ACCESS_WIDTH::HALF},
+        {0x7202, ACCESS_TYPE::WRITE, 0xCAFEBABE00C0FFEE, ACCESS_WIDTH::DOUBLE},
+        {0x7202, ACCESS_TYPE::READ, 0 /*dummy*/, ACCESS_WIDTH::DOUBLE},
+        {0x7202, ACCESS_TYPE::READ, 0 /*dummy*/, ACCESS_WIDTH::BYTE} // flash is accessed by words only
+    };
+
+    std::cout << "\nVariable width accesses on decoded bus:" << std::endl;
+    for (auto [addr, type, data, width] : sizedAccesses)
+    {
+        bool success = decodedBus->handleAccess(addr, type, data, width);
+        std::cout << (success ? "Success! " : "Failed! ") << std::dec << static_cast<int>(width) << " bytes "
+                  << (type == ACCESS_TYPE::READ ? "read 0x" : "written 0x") << std::hex << data << " at address 0x" << addr << std::endl;
     }
+
+    // The DMA copies 1 MB from RAM to flash while the CPU keeps going
+    constexpr Address DMA_BASE = 0x4000000;
+    auto dma = std::make_unique<DmaBusHandler>(DMA_BASE, *decodedBus);
+    decodedBus->map(dma.get());
+    dma->setCompletionCallback([](bool success) { std::cout << "DMA completion interrupt: " << (success ? "Success!" : "Failed!") << std::endl; });
+
+    uint32_t reg = 0x1000000;
+    decodedBus->handleRequest(DMA_BASE + DmaBusHandler::SOURCE, ACCESS_TYPE::WRITE, reg);
+    reg = 0x100000;
+    decodedBus->handleRequest(DMA_BASE + DmaBusHandler::DESTINATION, ACCESS_TYPE::WRITE, reg);
+    reg = 1024 * 1024;
+    decodedBus->handleRequest(DMA_BASE + DmaBusHandler::LENGTH, ACCESS_TYPE::WRITE, reg);
+    reg = DmaBusHandler::START;
+    decodedBus->handleRequest(DMA_BASE + DmaBusHandler::CONTROL, ACCESS_TYPE::WRITE, reg);
+
+    std::cout << "\nDMA started" << std::endl;
+    size_t polls = 0;
+    do
+    {
+        polls++; // CPU work would go here
+        decodedBus->handleRequest(DMA_BASE + DmaBusHandler::STATUS, ACCESS_TYPE::READ, reg);
+    } while (reg == static_cast<uint32_t>(DMA_STATUS::BUSY));
+    dma->waitIdle(); // the callback has run too
+    std::cout << "DMA status " << reg << " after " << std::dec << polls << " polls" << std::endl;
+
+    uint32_t copied = 0;
+    decodedBus->handleRequest(0x100020, ACCESS_TYPE::READ, copied);
+    std::cout << "Flash at 0x100020 now reads 0x" << std::hex << copied << std::endl;
+
+    // Copy a small firmware image in a single transaction, then read it back
+    std::array<std::byte, 64> image;
+    for (size_t i = 0; i < image.size(); ++i)
+        image[i] = std::byte(i);
+    std::array<std::byte, 64> readBack {};
+    bool burstOk = bus->handleBurst(0x1000100, ACCESS_TYPE::WRITE, image)
+                && decodedBus->handleBurst(0x1000100, ACCESS_TYPE::READ, readBack)
+                && (image == readBack);
+    std::cout << "\nBurst copy of " << std::dec << image.size() << " bytes: " << (burstOk ? "Success!" : "Failed!") << std::endl;
+
+    std::vector<Request> batch;
+    for (const auto& [addr, type, data] : accesses)
+        batch.push_back(Request{addr, type, data});
+    std::cout << "\nBatch on decoded bus:" << std::endl;
+    decodedBus->handleBatch(batch);
+    for (const auto& r : batch)
+        std::cout << (r.success ? "Success! " : "Failed! ") << "0x" << std::hex << r.address << " -> 0x" << r.data << std::endl;
 }
@@ -0,0 +1,80 @@
+// Checks that bus masters running on several threads lose no update
+#include "Bus.h"
+
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    BusHandler::setVerbose(false);
+
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr Address FLASH_BASE = FlashMemoryBusHandler::START_ADDRESS;
+    constexpr unsigned THREADS = 4;
+    constexpr unsigned ITERATIONS = 20000;
+    constexpr unsigned PAGES = 64;
+
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+    BusHandler bus;
+    bus.setNext(ram.get())->setNext(flash.get());
+
+    uint32_t zero = 0;
+    bus.handleRequest(RAM_BASE, ACCESS_TYPE::WRITE, zero);
+
+    std::vector<std::thread> masters;
+    for (unsigned t = 0; t < THREADS; ++t)
+        masters.emplace_back([&bus, t]
+        {
+            for (unsigned i = 0; i < ITERATIONS; ++i)
+            {
+                uint32_t one = 1;
+                bus.handleAtomic(RAM_BASE, ATOMIC_OP::FETCH_ADD, one);
+                one = 1;
+                bus.handleAtomic(FLASH_BASE, ATOMIC_OP::FETCH_ADD, one);
+            }
+            // every master writes its own word of the same pages, allocated by whoever comes first
+            for (unsigned page = 0; page < PAGES; ++page)
+            {
+                uint32_t data = page * THREADS + t;
+                bus.handleRequest(FLASH_BASE + 0x1000 + page * PagedMemory::PAGE_SIZE + t * 4, ACCESS_TYPE::WRITE, data);
+            }
+        });
+    for (auto& m : masters)
+        m.join();
+
+    uint32_t data = 0;
+    check(bus.handleRequest(RAM_BASE, ACCESS_TYPE::READ, data) && (data == THREADS * ITERATIONS), "atomic increments of RAM");
+    check(bus.handleRequest(FLASH_BASE, ACCESS_TYPE::READ, data) && (data == THREADS * ITERATIONS), "atomic increments of flash");
+
+    bool allWords = true;
+    for (unsigned page = 0; page < PAGES; ++page)
+        for (unsigned t = 0; t < THREADS; ++t)
+        {
+            bus.handleRequest(FLASH_BASE + 0x1000 + page * PagedMemory::PAGE_SIZE + t * 4, ACCESS_TYPE::READ, data);
+            allWords = allWords && (data == page * THREADS + t);
+        }
+    check(allWords, "words written to pages allocated concurrently");
+
+    auto reference = std::make_unique<FlashMemoryBusHandler>();
+    reference->handleRequest(FLASH_BASE, ACCESS_TYPE::WRITE, data);
+    for (unsigned page = 0; page < PAGES; ++page)
+        reference->handleRequest(FLASH_BASE + 0x1000 + page * PagedMemory::PAGE_SIZE, ACCESS_TYPE::WRITE, data);
+    check(flash->allocatedBytes() == reference->allocatedBytes(), "one allocation per page");
+
+    std::cout << (failures ? "Concurrent bus test failed!" : "Concurrent bus test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
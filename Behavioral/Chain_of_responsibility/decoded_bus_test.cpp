@@ -0,0 +1,103 @@
+// Checks the routing of the decoded bus at the edges of the device windows
+#include "Bus.h"
+#include "DecodedBus.h"
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Device without a window, answering any address below its limit
+class CatchAllBusHandler : public BusHandler
+{
+public:
+    explicit CatchAllBusHandler(Address limit_)
+    : limit(limit_)
+    {}
+
+    bool handleRequest(Address address, ACCESS_TYPE type, uint32_t& data) override
+    {
+        if (address < limit)
+        {
+            data = 0xFA11BAC6;
+            return true;
+        }
+        return BusHandler::handleRequest(address, type, data);
+    }
+
+private:
+    const Address limit;
+};
+
+int main()
+{
+    BusHandler::setVerbose(false);
+
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr Address RAM_END = RAM_BASE + MainMemoryBusHandler::RAM_SIZE;
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    ROMBusHandler rom(0x0, 0x1000);
+    CatchAllBusHandler catchAll(0x2000);
+
+    DecodedBusHandler bus;
+    bus.map(ram.get());
+    bus.map(&rom);
+    bus.map(&catchAll);
+
+    uint32_t data = 0x12345678;
+    check(bus.handleRequest(RAM_BASE, ACCESS_TYPE::WRITE, data), "first word of RAM");
+    data = 0x9ABCDEF0;
+    check(bus.handleRequest(RAM_END - 4, ACCESS_TYPE::WRITE, data), "last word of RAM");
+    data = 0;
+    check(bus.handleRequest(RAM_BASE, ACCESS_TYPE::READ, data) && (data == 0x12345678), "first word of RAM read back");
+    check(bus.handleRequest(RAM_END - 4, ACCESS_TYPE::READ, data) && (data == 0x9ABCDEF0), "last word of RAM read back");
+    check(!bus.handleRequest(RAM_END - 2, ACCESS_TYPE::READ, data), "word crossing the end of RAM");
+    check(!bus.handleRequest(RAM_END, ACCESS_TYPE::READ, data), "first address after RAM");
+    check(!bus.handleRequest(RAM_BASE - 4, ACCESS_TYPE::READ, data), "last word before RAM");
+
+    check(bus.handleRequest(0xFFC, ACCESS_TYPE::READ, data) && (data == 0xDA7ADA7A), "last word of ROM");
+    check(!bus.handleRequest(0x0, ACCESS_TYPE::WRITE, data), "write to ROM");
+
+    data = 0;
+    check(bus.handleRequest(0x1000, ACCESS_TYPE::READ, data) && (data == 0xFA11BAC6), "device without window as fallback");
+    check(!bus.handleRequest(0x2000, ACCESS_TYPE::READ, data), "unmapped address");
+
+    uint32_t previous = 5;
+    check(bus.handleAtomic(RAM_BASE, ATOMIC_OP::FETCH_ADD, previous) && (previous == 0x12345678), "atomic routed to RAM");
+
+    uint64_t value = 0;
+    check(bus.handleAccess(RAM_BASE + 1, ACCESS_TYPE::READ, value, ACCESS_WIDTH::HALF) && (value == 0x3456), "access routed to RAM");
+
+    for (Address base : {Address{0x800}, RAM_END - 4})
+    {
+        ROMBusHandler overlapping(base, 0x1000);
+        bool rejected = false;
+        try
+        {
+            bus.map(&overlapping);
+        }
+        catch (const std::runtime_error&)
+        {
+            rejected = true;
+        }
+        check(rejected, "overlapping window rejected");
+    }
+
+    ROMBusHandler adjacent(RAM_END, 0x1000);
+    bus.map(&adjacent);
+    check(bus.handleRequest(RAM_END, ACCESS_TYPE::READ, data) && (data == 0xDA7ADA7A), "window right after RAM");
+    check(bus.handleRequest(RAM_END - 4, ACCESS_TYPE::READ, data) && (data == 0x9ABCDEF0), "RAM before the adjacent window");
+
+    std::cout << (failures ? "Decoded bus test failed!" : "Decoded bus test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+// Checks the transfers and the registers of the DMA controller
+#include "Bus.h"
+#include "DmaBusHandler.h"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+constexpr Address DMA_BASE = 0x2000;
+
+void startTransfer(BusHandler& bus, uint32_t source, uint32_t destination, uint32_t length)
+{
+    bus.handleRequest(DMA_BASE + DmaBusHandler::SOURCE, ACCESS_TYPE::WRITE, source);
+    bus.handleRequest(DMA_BASE + DmaBusHandler::DESTINATION, ACCESS_TYPE::WRITE, destination);
+    bus.handleRequest(DMA_BASE + DmaBusHandler::LENGTH, ACCESS_TYPE::WRITE, length);
+    uint32_t start = DmaBusHandler::START;
+    bus.handleRequest(DMA_BASE + DmaBusHandler::CONTROL, ACCESS_TYPE::WRITE, start);
+}
+
+DMA_STATUS readStatus(BusHandler& bus)
+{
+    uint32_t status = 0;
+    bus.handleRequest(DMA_BASE + DmaBusHandler::STATUS, ACCESS_TYPE::READ, status);
+    return static_cast<DMA_STATUS>(status);
+}
+
+int main()
+{
+    BusHandler::setVerbose(false);
+
+    constexpr Address RAM_BASE = 0x1000000;
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    ROMBusHandler rom(0x0, 0x1000);
+    BusHandler bus;
+    DmaBusHandler dma(DMA_BASE, bus);
+    bus.setNext(&dma)->setNext(ram.get())->setNext(&rom);
+
+    std::atomic<int> completions {0};
+    std::atomic<bool> lastOutcome {false};
+    dma.setCompletionCallback([&](bool success)
+    {
+        lastOutcome = success;
+        completions++;
+    });
+
+    check(readStatus(bus) == DMA_STATUS::IDLE, "idle at first");
+    uint32_t data = 0x1234;
+    check(bus.handleRequest(DMA_BASE + DmaBusHandler::LENGTH, ACCESS_TYPE::WRITE, data), "register write");
+    data = 0;
+    check(bus.handleRequest(DMA_BASE + DmaBusHandler::LENGTH, ACCESS_TYPE::READ, data) && (data == 0x1234), "register read back");
+    check(!bus.handleRequest(DMA_BASE + 2, ACCESS_TYPE::READ, data), "unaligned register access rejected");
+
+    // several chunks, the last one partial
+    constexpr uint32_t LENGTH = 3 * DmaBusHandler::CHUNK_SIZE + 12;
+    std::vector<std::byte> pattern(LENGTH);
+    for (size_t i = 0; i < pattern.size(); ++i)
+        pattern[i] = static_cast<std::byte>(i * 7);
+    bus.handleBurst(RAM_BASE, ACCESS_TYPE::WRITE, pattern);
+
+    startTransfer(bus, RAM_BASE, RAM_BASE + 0x100000, LENGTH);
+    dma.waitIdle();
+    std::vector<std::byte> copied(LENGTH);
+    bus.handleBurst(RAM_BASE + 0x100000, ACCESS_TYPE::READ, copied);
+    check(copied == pattern, "multi-chunk transfer");
+    check(readStatus(bus) == DMA_STATUS::DONE, "done after a transfer");
+    check((completions == 1) && lastOutcome, "completion callback");
+
+    data = 0;
+    bus.handleRequest(DMA_BASE + DmaBusHandler::STATUS, ACCESS_TYPE::WRITE, data);
+    check(readStatus(bus) == DMA_STATUS::IDLE, "status acknowledged");
+
+    startTransfer(bus, RAM_BASE, RAM_BASE + 0x200000, 0);
+    dma.waitIdle();
+    check(readStatus(bus) == DMA_STATUS::DONE, "empty transfer");
+
+    // the second transfer writes to ROM
+    startTransfer(bus, RAM_BASE, RAM_BASE + 0x300000, 64);
+    startTransfer(bus, RAM_BASE, 0x0, 64);
+    dma.waitIdle();
+    check(readStatus(bus) == DMA_STATUS::ERROR, "error when a transfer fails");
+    check(!lastOutcome, "failure reported to the callback");
+
+    startTransfer(bus, RAM_BASE, RAM_BASE + 0x300000, 64);
+    dma.waitIdle();
+    check(readStatus(bus) == DMA_STATUS::DONE, "error cleared by the next transfer");
+
+    std::cout << (failures ? "DMA test failed!" : "DMA test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
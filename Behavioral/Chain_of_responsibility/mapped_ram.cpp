@@ -0,0 +1,46 @@
+#include "MappedRAM.h"
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+
+int main(int argc, const char* argv[])
+{
+    const std::string snapshotPath = (argc > 1) ? argv[1] : "ram_snapshot.bin";
+
+    // The whole 4 GB address space is RAM, only the touched pages are allocated
+    auto ram = std::make_unique<MappedRAMBusHandler>(0x0, size_t{4} * 1024 * 1024 * 1024);
+    BusHandler bus;
+    bus.setNext(ram.get());
+
+    uint32_t data = 0x12345678;
+    bus.handleRequest(0x1000, ACCESS_TYPE::WRITE, data);
+    data = 0xCAFE;
+    bus.handleRequest(0xFFFFFFFC, ACCESS_TYPE::WRITE, data);
+    std::cout << "Dirty pages after two writes: " << ram->dirtyPages() << std::endl;
+
+    if (!ram->saveSnapshot(snapshotPath))
+    {
+        std::cout << "Failed to save " << snapshotPath << std::endl;
+        return 1;
+    }
+    ram.reset();
+
+    // Instant startup: the snapshot is mapped copy-on-write, not read
+    auto restored = std::make_unique<MappedRAMBusHandler>(0x0, snapshotPath);
+    bus.setNext(restored.get());
+    bus.handleRequest(0x1000, ACCESS_TYPE::READ, data);
+    std::cout << "Restored 0x" << std::hex << data;
+    bus.handleRequest(0xFFFFFFFC, ACCESS_TYPE::READ, data);
+    std::cout << " and 0x" << data << std::dec << std::endl;
+
+    data = 0xABCD;
+    bus.handleRequest(0x2000, ACCESS_TYPE::WRITE, data);
+    data = 1;
+    bus.handleAtomic(0x3000, ATOMIC_OP::FETCH_ADD, data);
+    std::cout << "Write back of " << restored->dirtyPages() << " dirty pages: "
+              << (restored->writeBack() ? "Success!" : "Failed!") << std::endl;
+
+    std::remove(snapshotPath.c_str());
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Checks the mapped RAM device and its snapshot files
+#include "MappedRAM.h"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+template <typename F>
+void checkThrows(F f, const char* what)
+{
+    bool thrown = false;
+    try
+    {
+        f();
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, what);
+}
+
+int main()
+{
+    BusHandler::setVerbose(false);
+    const std::string path = (std::filesystem::temp_directory_path() / "mapped_ram_test.bin").string();
+    const std::string copyPath = path + ".copy";
+
+    checkThrows([] { MappedRAMBusHandler ram(0x0, 0); }, "empty RAM rejected");
+    checkThrows([] { MappedRAMBusHandler ram(0xFFFFF000, 0x2000); }, "RAM beyond the address space rejected");
+    checkThrows([&] { MappedRAMBusHandler ram(0x0, path + ".missing"); }, "missing snapshot rejected");
+
+    constexpr Address BASE = 0x10000;
+    constexpr size_t SIZE = 4 * MappedRAMBusHandler::PAGE_SIZE;
+    auto ram = std::make_unique<MappedRAMBusHandler>(BASE, SIZE);
+    check(ram->dirtyPages() == 0, "no dirty page at first");
+    check(!ram->writeBack(), "no write back without a snapshot");
+
+    uint32_t data = 0x11223344;
+    check(ram->handleRequest(BASE + SIZE - 4, ACCESS_TYPE::WRITE, data), "last word");
+    check(!ram->handleRequest(BASE + SIZE - 2, ACCESS_TYPE::WRITE, data), "word crossing the end");
+    check(!ram->handleRequest(BASE - 4, ACCESS_TYPE::READ, data), "word before the window");
+    data = 0xAABBCCDD;
+    check(ram->handleRequest(BASE + MappedRAMBusHandler::PAGE_SIZE - 2, ACCESS_TYPE::WRITE, data), "unaligned word across pages");
+    check(ram->dirtyPages() == 3, "dirty pages");
+
+    data = 0;
+    check(ram->handleRequest(BASE + MappedRAMBusHandler::PAGE_SIZE - 2, ACCESS_TYPE::READ, data) && (data == 0xAABBCCDD), "unaligned word read back");
+    data = 1;
+    check(!ram->handleAtomic(BASE + 2, ATOMIC_OP::FETCH_ADD, data), "unaligned atomic rejected");
+    data = 0x44;
+    check(ram->handleAtomic(BASE + SIZE - 4, ATOMIC_OP::FETCH_ADD, data) && (data == 0x11223344), "atomic returns the previous value");
+    data = 0;
+    check(ram->handleAtomic(BASE + SIZE - 4, ATOMIC_OP::COMPARE_EXCHANGE, data, 1) && (data == 0x11223388), "failed compare exchange");
+
+    std::array<std::byte, 8> bytes {};
+    check(ram->handleBurst(BASE + SIZE - 8, ACCESS_TYPE::READ, bytes) && (bytes[4] == std::byte{0x88}), "burst ending at the end");
+    check(!ram->handleBurst(BASE + SIZE - 4, ACCESS_TYPE::READ, bytes), "burst crossing the end");
+
+    check(ram->saveSnapshot(path), "snapshot saved");
+    ram.reset();
+
+    ram = std::make_unique<MappedRAMBusHandler>(BASE, path);
+    check(ram->window()->size == SIZE, "snapshot size");
+    check(ram->handleRequest(BASE + SIZE - 4, ACCESS_TYPE::READ, data) && (data == 0x11223388), "snapshot content");
+    check(ram->dirtyPages() == 0, "no dirty page after loading");
+
+    data = 0x5A5A5A5A;
+    ram->handleRequest(BASE, ACCESS_TYPE::WRITE, data);
+    check(ram->saveSnapshot(copyPath), "copy of a snapshot saved");
+    check(ram->writeBack() && (ram->dirtyPages() == 0), "write back");
+    ram.reset();
+
+    for (const std::string& p : {path, copyPath})
+    {
+        MappedRAMBusHandler reloaded(BASE, p);
+        data = 0;
+        reloaded.handleRequest(BASE, ACCESS_TYPE::READ, data);
+        check(data == 0x5A5A5A5A, "written back page");
+        reloaded.handleRequest(BASE + SIZE - 4, ACCESS_TYPE::READ, data);
+        check(data == 0x11223388, "pages kept from the snapshot");
+    }
+
+    std::remove(path.c_str());
+    std::remove(copyPath.c_str());
+    std::cout << (failures ? "Mapped RAM test failed!" : "Mapped RAM test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
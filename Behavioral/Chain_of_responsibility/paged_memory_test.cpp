@@ -0,0 +1,79 @@
+// Checks the sparse storage of the flash memory
+#include "PagedMemory.h"
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+bool allEqual(std::span<const std::byte> bytes, std::byte value)
+{
+    for (auto b : bytes)
+        if (b != value)
+            return false;
+    return true;
+}
+
+int main()
+{
+    constexpr size_t PAGE = PagedMemory::PAGE_SIZE;
+    auto memory = std::make_unique<PagedMemory>();
+
+    std::array<std::byte, 16> bytes;
+    bytes.fill(std::byte{0xFF});
+    memory->read(0x12345678, bytes);
+    check(allEqual(bytes, std::byte{0}), "never written memory reads as zero");
+    check(memory->loadWord(0xFFFFFFFC) == 0, "never written word reads as zero");
+    check(memory->allocatedBytes() == 0, "reads allocate nothing");
+
+    memory->write(0x1000, std::span<const std::byte>());
+    check(memory->allocatedBytes() == 0, "empty write allocates nothing");
+
+    // crossing a page boundary, and the boundary between two tables
+    constexpr uint32_t TABLE_END = PagedMemory::TABLE_SIZE * PAGE;
+    bytes.fill(std::byte{0xAB});
+    memory->write(TABLE_END - 8, bytes);
+    size_t twoPages = memory->allocatedBytes();
+    std::array<std::byte, 16> readBack {};
+    memory->read(TABLE_END - 8, readBack);
+    check(readBack == bytes, "write crossing two tables read back");
+    check(memory->loadWord(TABLE_END - 12) == 0, "word before the write untouched");
+    check(memory->loadWord(TABLE_END + 8) == 0, "word after the write untouched");
+
+    memory->storeWord(0xFFFFFFFC, 0xCAFE);
+    check(memory->loadWord(0xFFFFFFFC) == 0xCAFE, "last word of the address space");
+    memory->word(0xFFFFFFF8) = 0xBEEF;
+    check(memory->loadWord(0xFFFFFFF8) == 0xBEEF, "word reference");
+    check(memory->allocatedBytes() > twoPages, "last page allocated");
+
+    // partial page: cleared, still allocated
+    size_t allocated = memory->allocatedBytes();
+    memory->erase(TABLE_END - 4, 8);
+    memory->read(TABLE_END - 8, readBack);
+    check(allEqual(std::span(readBack).first(4), std::byte{0xAB}) && allEqual(std::span(readBack).subspan(4, 8), std::byte{0})
+          && allEqual(std::span(readBack).last(4), std::byte{0xAB}), "partial erase");
+    check(memory->allocatedBytes() == allocated, "partial erase keeps the pages");
+
+    // whole pages: released
+    memory->erase(TABLE_END - PAGE, 2 * PAGE);
+    memory->read(TABLE_END - 8, readBack);
+    check(allEqual(readBack, std::byte{0}), "erased pages read as zero");
+    check(memory->allocatedBytes() == allocated - 2 * PAGE, "erase releases whole pages");
+
+    memory->erase(0x5000, PAGE);
+    check(memory->allocatedBytes() == allocated - 2 * PAGE, "erasing unallocated pages");
+
+    std::cout << (failures ? "Paged memory test failed!" : "Paged memory test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
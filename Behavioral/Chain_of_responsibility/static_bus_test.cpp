@@ -0,0 +1,80 @@
+// Checks the routing of the static bus at the edges of the device windows
+#include "Bus.h"
+#include "StaticBus.h"
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    BusHandler::setVerbose(false);
+
+    constexpr Address RAM_BASE = 0x1000000;
+    constexpr Address RAM_END = RAM_BASE + MainMemoryBusHandler::RAM_SIZE;
+    constexpr Address FLASH_END = FlashMemoryBusHandler::END_ADDRESS;
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    ROMBusHandler rom(0x0, 0x1000);
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+    StaticBus bus(*ram, rom, *flash);
+
+    uint32_t data = 0x12345678;
+    check(bus.handleRequest(RAM_END - 4, ACCESS_TYPE::WRITE, data), "last word of RAM");
+    check(!bus.handleRequest(RAM_END - 2, ACCESS_TYPE::WRITE, data), "word crossing the end of RAM");
+    check(!bus.handleRequest(RAM_END, ACCESS_TYPE::READ, data), "first address after RAM");
+    check(bus.handleRequest(0xFFC, ACCESS_TYPE::READ, data) && (data == 0xDA7ADA7A), "last word of ROM");
+    check(!bus.handleRequest(0xFFE, ACCESS_TYPE::READ, data), "word crossing the end of ROM");
+
+    uint64_t value = 0;
+    check(bus.handleAccess(RAM_END - 1, ACCESS_TYPE::READ, value, ACCESS_WIDTH::BYTE) && (value == 0x12), "last byte of RAM");
+    check(!bus.handleAccess(RAM_END - 4, ACCESS_TYPE::READ, value, ACCESS_WIDTH::DOUBLE), "double word crossing the end of RAM");
+    check(!bus.handleAccess(FLASH_END - 1, ACCESS_TYPE::READ, value, ACCESS_WIDTH::BYTE), "width not served by the flash");
+    value = 0x1122334455667788;
+    check(bus.handleAccess(FLASH_END - 8, ACCESS_TYPE::WRITE, value, ACCESS_WIDTH::DOUBLE), "last double word of flash");
+
+    std::array<std::byte, 8> bytes {};
+    check(bus.handleBurst(FLASH_END - 8, ACCESS_TYPE::READ, bytes) && (bytes[0] == std::byte{0x88}), "burst ending at the end of flash");
+    check(!bus.handleBurst(FLASH_END - 4, ACCESS_TYPE::READ, bytes), "burst crossing the end of flash");
+    check(!bus.handleBurst(RAM_END, ACCESS_TYPE::READ, bytes), "burst out of any window");
+
+    data = 1;
+    check(bus.handleAtomic(FLASH_END - 4, ATOMIC_OP::FETCH_ADD, data) && (data == 0x11223344), "atomic on flash");
+    check(!bus.handleAtomic(FLASH_END - 2, ATOMIC_OP::FETCH_ADD, data), "atomic crossing the end of flash");
+
+    std::array<Request, 3> batch
+    {{
+        {RAM_BASE, ACCESS_TYPE::WRITE, 0xCAFE},
+        {RAM_BASE, ACCESS_TYPE::READ, 0},
+        {RAM_END, ACCESS_TYPE::READ, 0}
+    }};
+    check(!bus.handleBatch(batch), "batch with a failing request");
+    check(batch[0].success && batch[1].success && !batch[2].success && (batch[1].data == 0xCAFE), "outcome of the batch");
+
+    BusHandler windowless;
+    bool rejected = false;
+    try
+    {
+        StaticBus invalid(rom, windowless);
+    }
+    catch (const std::runtime_error&)
+    {
+        rejected = true;
+    }
+    check(rejected, "device without window rejected");
+
+    std::cout << (failures ? "Static bus test failed!" : "Static bus test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+// Replays binary bus traces and generates synthetic ones.
+//   traceReplay generate <file> <sequential|random|strided> <count> [seed or stride]
+//   traceReplay replay <file> [chain|decoded|cached|static|l1l2]
+#include "Bus.h"
+#include "CacheBusHandler.h"
+#include "CachedBus.h"
+#include "DecodedBus.h"
+#include "StaticBus.h"
+#include "Trace.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Board of the demo
+constexpr Address RAM_BASE = 0x1000000;
+constexpr Address ROM_BASE = 0x3000000;
+constexpr size_t ROM_SIZE = 16 * 1024;
+
+std::vector<TraceRecord> generate(const std::string& pattern, size_t count, uint32_t parameter)
+{
+    std::vector<TraceRecord> records(count);
+    if (pattern == "sequential")
+    {
+        // write then read back every word of RAM, in order
+        for (size_t i = 0; i < count; ++i)
+        {
+            Address address = RAM_BASE + static_cast<Address>((i / 2) * 4 % (MainMemoryBusHandler::RAM_SIZE - 4));
+            records[i] = TraceRecord{address, static_cast<uint32_t>(i), (i % 2) ? ACCESS_TYPE::READ : ACCESS_TYPE::WRITE};
+        }
+    }
+    else if (pattern == "random")
+    {
+        // any device, 70% reads, a few unmapped addresses
+        std::mt19937 rng(parameter);
+        const AddressWindow windows[] =
+        {
+            {RAM_BASE, MainMemoryBusHandler::RAM_SIZE - 4},
+            {ROM_BASE, ROM_SIZE - 4},
+            {FlashMemoryBusHandler::START_ADDRESS, FlashMemoryBusHandler::END_ADDRESS - FlashMemoryBusHandler::START_ADDRESS - 4},
+            {0x100, 0x1000} // unmapped
+        };
+        for (auto& r : records)
+        {
+            const AddressWindow& w = windows[(rng() % 100 < 2) ? 3 : rng() % 3];
+            r = TraceRecord{w.base + static_cast<Address>(rng() % (w.size / 4)) * 4, static_cast<uint32_t>(rng()),
+                            (rng() % 10 < 7) ? ACCESS_TYPE::READ : ACCESS_TYPE::WRITE};
+        }
+    }
+    else if (pattern == "strided")
+    {
+        // reads over RAM with a fixed stride, wrapping around
+        uint32_t stride = parameter ? parameter : 4096;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Address address = RAM_BASE + static_cast<Address>(i * stride % (MainMemoryBusHandler::RAM_SIZE - 4)) / 4 * 4;
+            records[i] = TraceRecord{address, 0, ACCESS_TYPE::READ};
+        }
+    }
+    else
+        throw std::runtime_error("Unknown pattern " + pattern);
+    return records;
+}
+
+// Streams the trace through the bus, collecting the outcome of each access
+template <typename BUS>
+double replay(BUS& bus, std::span<const TraceRecord> records, std::vector<bool>& success)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        uint32_t data = records[i].data;
+        success[i] = bus.handleRequest(records[i].address, records[i].type, data);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string command = (argc > 2) ? argv[1] : "";
+    if ((command == "generate") && (argc > 4))
+    {
+        uint32_t parameter = (argc > 5) ? static_cast<uint32_t>(std::stoul(argv[5])) : 0;
+        auto records = generate(argv[3], std::stoull(argv[4]), parameter);
+        if (!writeTrace(argv[2], records))
+        {
+            std::cout << "Failed to write " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cout << "Written " << records.size() << " accesses to " << argv[2] << std::endl;
+        return 0;
+    }
+    if (command != "replay")
+    {
+        std::cout << "Usage: " << argv[0] << " generate <file> <sequential|random|strided> <count> [seed or stride]\n"
+                  << "       " << argv[0] << " replay <file> [chain|decoded|cached|static|l1l2]" << std::endl;
+        return 1;
+    }
+
+    MappedTrace trace(argv[2]);
+    const std::string config = (argc > 3) ? argv[3] : "chain";
+
+    auto ram = std::make_unique<MainMemoryBusHandler>(RAM_BASE);
+    auto rom = std::make_unique<ROMBusHandler>(ROM_BASE, ROM_SIZE);
+    auto flash = std::make_unique<FlashMemoryBusHandler>();
+    const BusHandler* devices[] = {ram.get(), rom.get(), flash.get()};
+    const char* deviceNames[] = {"RAM", "ROM", "flash"};
+
+    BusHandler::setVerbose(false); // no I/O while replaying
+    std::vector<bool> success(trace.records().size());
+    double seconds = 0;
+    if (config == "chain")
+    {
+        BusHandler bus;
+        bus.setNext(ram.get())->setNext(rom.get())->setNext(flash.get());
+        seconds = replay(bus, trace.records(), success);
+    }
+    else if (config == "decoded")
+    {
+        DecodedBusHandler bus;
+        bus.map(ram.get());
+        bus.map(rom.get());
+        bus.map(flash.get());
+        seconds = replay(bus, trace.records(), success);
+    }
+    else if (config == "cached")
+    {
+        CachedBusHandler<> bus;
+        bus.setNext(ram.get())->setNext(rom.get())->setNext(flash.get());
+        seconds = replay(bus, trace.records(), success);
+    }
+    else if (config == "static")
+    {
+        StaticBus bus(*ram, *rom, *flash);
+        seconds = replay(bus, trace.records(), success);
+    }
+    else if (config == "l1l2")
+    {
+        // chain with a cache model in front of RAM
+        CacheBusHandler l2(CacheConfig{256 * 1024, 64, 16, REPLACEMENT::LRU, WRITE_POLICY::WRITE_BACK, 12, 200});
+        CacheBusHandler l1(CacheConfig{32 * 1024, 64, 8, REPLACEMENT::LRU, WRITE_POLICY::WRITE_BACK, 4, 200}, &l2);
+        BusHandler bus;
+        bus.setNext(&l1)->setNext(ram.get())->setNext(rom.get())->setNext(flash.get());
+        seconds = replay(bus, trace.records(), success);
+
+        for (auto [name, stats] : {std::pair{"L1", l1.getStats()}, std::pair{"L2", l2.getStats()}})
+            std::cout << name << ": " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions
+                      << " evictions, " << stats.writeBacks << " write-backs, " << stats.cycles << " cycles" << std::endl;
+    }
+    else
+    {
+        std::cout << "Unknown bus configuration " << config << std::endl;
+        return 1;
+    }
+
+    // Successful accesses are attributed to the device owning the address
+    size_t hits[std::size(devices)] {};
+    size_t failures = 0;
+    for (size_t i = 0; i < success.size(); ++i)
+    {
+        if (!success[i])
+        {
+            failures++;
+            continue;
+        }
+        for (size_t d = 0; d < std::size(devices); ++d)
+            if (devices[d]->window()->contains(trace.records()[i].address))
+                hits[d]++;
+    }
+
+    size_t total = success.size();
+    uint64_t rate = (total && (seconds > 0)) ? static_cast<uint64_t>(total / seconds) : 0; // an empty trace takes no time
+    std::cout << total << " accesses on " << config << " bus in " << seconds << " s: "
+              << rate << " accesses/sec" << std::endl;
+    for (size_t d = 0; d < std::size(devices); ++d)
+        std::cout << "  " << deviceNames[d] << ": " << hits[d] << " hits" << std::endl;
+    std::cout << "  failures: " << failures << " (" << (total ? 100.0 * failures / total : 0.0) << "%)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Checks the trace files written and mapped back
+#include "Trace.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+bool rejected(const std::string& path)
+{
+    try
+    {
+        MappedTrace trace(path);
+    }
+    catch (const std::runtime_error&)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "trace_test.bin").string();
+
+    check(writeTrace(path, {}), "empty trace written");
+    {
+        MappedTrace trace(path);
+        check(trace.records().empty(), "empty trace");
+    }
+
+    std::vector<TraceRecord> records
+    {
+        {0x1000000, 0xCAFE, ACCESS_TYPE::WRITE},
+        {0x1000000, 0, ACCESS_TYPE::READ},
+        {0xFFFFFFFC, 0, ACCESS_TYPE::READ}
+    };
+    check(writeTrace(path, records), "trace written");
+    {
+        MappedTrace trace(path);
+        auto mapped = trace.records();
+        check(mapped.size() == records.size(), "record count");
+        bool same = true;
+        for (size_t i = 0; (i < mapped.size()) && (i < records.size()); ++i)
+            same = same && (mapped[i].address == records[i].address) && (mapped[i].data == records[i].data)
+                        && (mapped[i].type == records[i].type);
+        check(same, "records read back");
+    }
+
+    // the header announces more records than the file holds
+    std::filesystem::resize_file(path, sizeof(TraceHeader) + 2 * sizeof(TraceRecord) + 1);
+    check(rejected(path), "truncated trace rejected");
+
+    std::filesystem::resize_file(path, sizeof(TraceHeader) - 1);
+    check(rejected(path), "file shorter than the header rejected");
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        TraceHeader header{};
+        memcpy(header.magic, "NOTRACE!", sizeof(header.magic));
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    check(rejected(path), "wrong magic rejected");
+
+    std::remove(path.c_str());
+    check(rejected(path), "missing trace rejected");
+
+    std::cout << (failures ? "Trace test failed!" : "Trace test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "Command.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Kernels built for AVX2 too, the best version is picked at load time
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BATCH_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define BATCH_KERNEL
+#endif
+
+// Deposits and withdrawals to apply together, stored as one array per field
+struct CommandBatch
+{
+    void add(uint32_t account, BankAccountCommand::Action action, unsigned amount)
+    {
+        accounts.push_back(account);
+        amounts.push_back(amount);
+        withdrawals.push_back(action == BankAccountCommand::Action::withdraw);
+    }
+
+    size_t size() const
+    {
+        return accounts.size();
+    }
+
+    void clear()
+    {
+        accounts.clear();
+        amounts.clear();
+        withdrawals.clear();
+    }
+
+    std::vector<uint32_t> accounts;
+    std::vector<uint32_t> amounts;
+    std::vector<uint8_t> withdrawals; // 1 for a withdrawal, 0 for a deposit
+};
+
+/*
+ * Balances of accounts indexed by id, in one array. apply() gives the same
+ * results as running the commands in order, but only replays the commands
+ * of the accounts whose balance does not cover all their withdrawals.
+ */
+class BalanceTable
+{
+public:
+    explicit BalanceTable(size_t accountCount, unsigned initialBalance = 0)
+    : balances(accountCount, initialBalance)
+    , totals(accountCount)
+    , covered(accountCount)
+    {}
+
+    size_t size() const
+    {
+        return balances.size();
+    }
+
+    unsigned balance(size_t id) const
+    {
+        return balances[id];
+    }
+
+    std::span<const unsigned> data() const
+    {
+        return balances;
+    }
+
+    // One command at a time, in batch order; success gets a flag per command
+    void applyScalar(const CommandBatch& batch, std::vector<uint8_t>& success)
+    {
+        check(batch);
+        success.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i)
+            success[i] = applyOne(balances[batch.accounts[i]], batch.amounts[i], batch.withdrawals[i]);
+    }
+
+    // Same result as applyScalar()
+    void apply(const CommandBatch& batch, std::vector<uint8_t>& success)
+    {
+        check(batch);
+        const size_t n = batch.size();
+        success.resize(n);
+
+        // group by account: totals per account touched, scattered rather than sorted
+        touched.clear();
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint64_t mask = uint64_t{0} - batch.withdrawals[i];
+            Totals& t = totals[batch.accounts[i]];
+            if (covered[batch.accounts[i]] != LISTED)
+            {
+                covered[batch.accounts[i]] = LISTED;
+                touched.push_back(batch.accounts[i]);
+            }
+            t.withdrawn += batch.amounts[i] & mask;
+            t.deposited += batch.amounts[i] & ~mask;
+        }
+
+        // overdraft check, vectorized over all the accounts when many are touched
+        size_t uncovered = 0;
+        if (touched.size() * DENSE_RATIO >= balances.size())
+            uncovered = settleAll(balances.data(), totals.data(), covered.data(), balances.size());
+        else
+        {
+            for (uint32_t id : touched)
+                uncovered += !settle(id);
+        }
+
+        if (uncovered == 0)
+        {
+            std::fill(success.begin(), success.end(), 1);
+            return;
+        }
+        // the balances of uncovered accounts are untouched: replay their commands in order
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint32_t account = batch.accounts[i];
+            success[i] = covered[account] ? 1 : applyOne(balances[account], batch.amounts[i], batch.withdrawals[i]);
+        }
+    }
+
+private:
+    static constexpr size_t DENSE_RATIO = 4;
+    static constexpr uint8_t LISTED = 2;
+
+    struct Totals // together: one cache line touched per command
+    {
+        uint64_t deposited {0};
+        uint64_t withdrawn {0};
+    };
+
+    // Applies the totals of an account if its balance covers them, returns whether it does
+    static bool settle(unsigned& balance, Totals& t, uint8_t& covered)
+    {
+        uint64_t b = balance;
+        bool ok = (t.withdrawn <= b) & (b + t.deposited <= UINT32_MAX); // no wrap around either
+        covered = ok;
+        balance = static_cast<unsigned>(ok ? b + t.deposited - t.withdrawn : b);
+        t = Totals{};
+        return ok;
+    }
+
+    bool settle(size_t id)
+    {
+        return settle(balances[id], totals[id], covered[id]);
+    }
+
+    // settle() on every account, returns how many are not covered
+    BATCH_KERNEL
+    static size_t settleAll(unsigned* __restrict balances, Totals* __restrict totals, uint8_t* __restrict covered, size_t count)
+    {
+        size_t uncovered = 0;
+        for (size_t id = 0; id < count; ++id)
+            uncovered += !settle(balances[id], totals[id], covered[id]);
+        return uncovered;
+    }
+
+    static bool applyOne(unsigned& balance, unsigned amount, bool withdrawal)
+    {
+        if (!withdrawal)
+        {
+            balance += amount;
+            return true;
+        }
+        if (balance < amount)
+            return false;
+        balance -= amount;
+        return true;
+    }
+
+    void check(const CommandBatch& batch) const
+    {
+        if ((batch.amounts.size() != batch.size()) || (batch.withdrawals.size() != batch.size()))
+            throw std::runtime_error("Inconsistent command batch!");
+        if (batch.size() > UINT32_MAX)
+            throw std::runtime_error("Command batch too large!");
+        for (uint32_t account : batch.accounts)
+            if (account >= balances.size())
+                throw std::runtime_error("Unknown account in command batch!");
+    }
+
+    std::vector<unsigned> balances;
+
+    // scratch buffers of apply(), one entry per account
+    std::vector<Totals> totals;
+    std::vector<uint8_t> covered;
+    std::vector<uint32_t> touched;
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Receives every change applied to the accounts it is attached to, e.g. to persist it
+struct AccountJournal
+{
+    // deposit is the action of the command, undo tells whether it is being undone
+    virtual void record(uint32_t accountId, bool deposit, unsigned amount, bool undo) = 0;
+    // The changes in between are replayed all or none; units may nest
+    virtual void beginUnit() {}
+    virtual void endUnit() {}
+    virtual ~AccountJournal() = default;
+};
+
+// Runs f, the sub-commands of a composite command, as one unit of journal
+template <typename F>
+void runAsUnit(AccountJournal* journal, F f)
+{
+    if (journal)
+        journal->beginUnit();
+    f();
+    if (journal)
+        journal->endUnit();
+}
+
+
+class BankAccount
+{
+    friend class BankAccountCommand;
+    friend class CommandJournal;
+public:
+    explicit BankAccount(const std::string& name_)
+    : name(name_)
+    {}
+
+    BankAccount(const std::string& name_, unsigned initial_amount)
+    : name(name_)
+    , balance(initial_amount)
+    {}
+
+    unsigned getBalance() const
+    {
+        return balance;
+    }
+
+    void printStats() const
+    {
+        std::cout << "Account \"" << name << "\" - Balance: " << balance << " EUR" << std::endl;
+    }
+
+private:
+    void deposit(unsigned amount)
+    {
+        balance += amount;
+    }
+
+    bool withdraw(unsigned amount)
+    {
+        if (balance >= amount)
+        {
+            balance -= amount;
+            return true;
+        }
+        return false;
+    }
+
+    void log(bool deposit, unsigned amount, bool undo)
+    {
+        if (journal)
+            journal->record(id, deposit, amount, undo);
+    }
+
+    const std::string name;
+    unsigned balance {0};
+    AccountJournal* journal {nullptr};
+    uint32_t id {0};
+};
+
+
+struct Command
+{
+    virtual void call() = 0;
+    virtual void undo() = 0;
+    virtual bool isSuccessful() const { return true; }
+    virtual ~Command() = default;
+};
+
+
+class BankAccountCommand : public Command
+{
+public:
+    enum class Action
+    {
+        deposit,
+        withdraw
+    };
+
+    BankAccountCommand(BankAccount& ba, Action action_, unsigned amount_)
+    : account(ba)
+    , action(action_)
+    , amount(amount_)
+    {}
+
+    void call() override
+    {
+        switch (action)
+        {
+        case Action::deposit:
+            account.deposit(amount);
+            successfulAction = true;
+            break;
+
+        case Action::withdraw:
+            successfulAction = account.withdraw(amount);
+            break;
+
+        default:
+            break;
+        }
+        if (successfulAction)
+            account.log(action == Action::deposit, amount, false);
+    }
+
+    void undo() override
+    {
+        if (undoneAction || !successfulAction)
+            return;
+
+        undoneAction = true;
+        switch (action)
+        {
+        case Action::deposit:
+            if (account.withdraw(amount))
+                account.log(true, amount, true);
+            break;
+
+        case Action::withdraw:
+            if (successfulAction)
+            {
+                account.deposit(amount);
+                account.log(false, amount, true);
+            }
+            break;
+
+        default:
+            undoneAction = false;
+            break;
+        }
+    }
+
+    bool isSuccessful() const override
+    {
+        return successfulAction;
+    }
+
+    AccountJournal* getJournal() const
+    {
+        return account.journal;
+    }
+
+private:
+    BankAccount& account;
+    const Action action;
+    bool successfulAction {false};
+    bool undoneAction {false};
+    const unsigned amount;
+};
+
+
+// The accounts of the sub-commands must share their journal, if any
+struct CompositeBankAccountCommand : std::vector<BankAccountCommand>, Command
+{
+    CompositeBankAccountCommand(const std::initializer_list<value_type>& items)
+    : std::vector<BankAccountCommand>(items)
+    {}
+
+    void call() override
+    {
+        runAsUnit(journal(), [this]
+        {
+            for (auto& cmd : *this)
+                cmd.call();
+        });
+    }
+
+    void undo() override
+    {
+        runAsUnit(journal(), [this]
+        {
+            for (auto it = rbegin(); it != rend(); ++it)
+                it->undo();
+        });
+    }
+
+    bool isSuccessful() const override
+    {
+        for (const auto& cmd : *this)
+            if (!cmd.isSuccessful())
+                return false;
+        return true;
+    }
+
+protected:
+    AccountJournal* journal() const
+    {
+        return empty() ? nullptr : front().getJournal();
+    }
+};
+
+
+struct DependentCompositeCommand : CompositeBankAccountCommand
+{
+    using CompositeBankAccountCommand::CompositeBankAccountCommand;
+
+    // Breakes chain if a command fails
+    void call() override
+    {
+        runAsUnit(journal(), [this]
+        {
+            for (auto& cmd : *this)
+            {
+                if (successfulChain)
+                {
+                    cmd.call();
+                    successfulChain = cmd.isSuccessful();
+                }
+            }
+        });
+    }
+
+private:
+    bool successfulChain {true};
+};
+
+
+struct BankTransferCommand : DependentCompositeCommand
+{
+    BankTransferCommand(BankAccount& from, BankAccount& to, unsigned amount)
+    : DependentCompositeCommand{BankAccountCommand{from, BankAccountCommand::Action::withdraw, amount},
+                                  BankAccountCommand{to, BankAccountCommand::Action::deposit, amount}}
+    {}
+};
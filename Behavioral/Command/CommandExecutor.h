@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Command.h"
+#include "MpscQueue.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <utility>
+
+/*
+ * Executes the commands submitted by any thread on its own thread, in order.
+ * Submitted commands must stay alive until their future is ready.
+ */
+class CommandExecutor
+{
+public:
+    CommandExecutor()
+    : worker([this](std::stop_token stop) { run(stop); })
+    {}
+
+    ~CommandExecutor()
+    {
+        worker.request_stop();
+        wakeUp();
+    }
+
+    CommandExecutor(const CommandExecutor&) = delete;
+    CommandExecutor& operator=(const CommandExecutor&) = delete;
+
+    std::future<bool> submit(Command& cmd)
+    {
+        std::promise<bool> promise;
+        auto result = promise.get_future();
+        queue.push(Task{&cmd, std::move(promise)});
+        wakeUp();
+        return result;
+    }
+
+    // Fire and forget, no future to allocate
+    void post(Command& cmd)
+    {
+        queue.push(Task{&cmd, std::nullopt});
+        wakeUp();
+    }
+
+    // Number of commands executed so far
+    uint64_t executed() const
+    {
+        return executedCount.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Task
+    {
+        Command* cmd;
+        std::optional<std::promise<bool>> promise;
+    };
+
+    void wakeUp()
+    {
+        submitted.fetch_add(1);
+        if (sleeping.load())
+            submitted.notify_one();
+    }
+
+    // Executes everything in the queue, returns how many commands it ran
+    size_t drain()
+    {
+        size_t count = 0;
+        size_t uncounted = 0;
+        while (auto task = queue.pop())
+        {
+            task->cmd->call();
+            count++;
+            uncounted++;
+            if (task->promise)
+            {
+                // counted before the future is ready
+                executedCount.fetch_add(std::exchange(uncounted, 0), std::memory_order_release);
+                task->promise->set_value(task->cmd->isSuccessful());
+            }
+        }
+        executedCount.fetch_add(uncounted, std::memory_order_release);
+        return count;
+    }
+
+    void run(std::stop_token stop)
+    {
+        while (true)
+        {
+            uint64_t seen = submitted.load();
+            if (drain())
+                continue;
+            if (stop.stop_requested())
+                return;
+
+            sleeping.store(true);
+            if (submitted.load() == seen)
+                submitted.wait(seen);
+            sleeping.store(false);
+        }
+    }
+
+    MpscQueue<Task> queue;
+    std::atomic<uint64_t> submitted {0};
+    std::atomic<bool> sleeping {false};
+    std::atomic<uint64_t> executedCount {0};
+    std::jthread worker; // last: started once everything else is constructed
+};
@@ -0,0 +1,350 @@
+#pragma once
+
+#include "Command.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct JournalConfig
+{
+    size_t groupSize {64};               // records written and synced together
+    size_t snapshotInterval {1u << 20};  // records between two snapshots, 0 to disable
+};
+
+// One change of a balance, as executed by a BankAccountCommand, in host byte order
+struct JournalRecord
+{
+    uint64_t sequence; // consecutive, starting from 1
+    uint32_t account;
+    uint32_t amount;
+    uint8_t deposit;
+    uint8_t undo;
+    uint8_t continued; // the next record belongs to the same command
+    uint8_t padding {};
+    uint32_t checksum {}; // of all the previous fields, detects torn writes
+
+    uint32_t computeChecksum() const
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        auto bytes = reinterpret_cast<const uint8_t*>(this);
+        for (size_t i = 0; i < offsetof(JournalRecord, checksum); ++i)
+            hash = (hash ^ bytes[i]) * 16777619u;
+        return hash;
+    }
+};
+
+static_assert(sizeof(JournalRecord) == 24);
+
+struct SnapshotHeader
+{
+    static constexpr char MAGIC[8] = {'B', 'A', 'N', 'K', 'S', 'N', 'A', 'P'};
+
+    char magic[8];
+    uint64_t sequence; // last record included
+    uint64_t count;    // balances following the header
+};
+
+/*
+ * Redo journal of the balances changed by commands (POSIX only), replayed on
+ * construction on top of the last snapshot. Records are synced by groups: call
+ * commit() when a command must be durable. Not thread-safe, like the accounts.
+ */
+class CommandJournal : public AccountJournal
+{
+public:
+    // accounts must stay in place while the journal exists, account ids are their indices
+    CommandJournal(const std::string& path_, std::span<BankAccount> accounts_, const JournalConfig& config_ = {})
+    : path(path_)
+    , snapshotPath(path_ + ".snapshot")
+    , accounts(accounts_)
+    , config(config_)
+    {
+        if (config.groupSize == 0)
+            throw std::runtime_error("Journal group size must be positive!");
+
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Unable to open journal " + path);
+
+        try
+        {
+            loadSnapshot();
+            replay();
+        }
+        catch (...)
+        {
+            close(fd);
+            throw;
+        }
+
+        for (size_t id = 0; id < accounts.size(); ++id)
+        {
+            accounts[id].journal = this;
+            accounts[id].id = static_cast<uint32_t>(id);
+        }
+        pending.reserve(config.groupSize);
+    }
+
+    ~CommandJournal()
+    {
+        try
+        {
+            commit();
+        }
+        catch (const std::runtime_error&)
+        {
+            // nobody to report to: the group is lost, as in a crash
+        }
+        for (auto& account : accounts)
+            account.journal = nullptr;
+        close(fd);
+    }
+
+    CommandJournal(const CommandJournal&) = delete;
+    CommandJournal& operator=(const CommandJournal&) = delete;
+
+    void record(uint32_t accountId, bool deposit, unsigned amount, bool undo) override
+    {
+        JournalRecord r{++sequence, accountId, amount, deposit, undo, depth > 0};
+        r.checksum = r.computeChecksum();
+        pending.push_back(r);
+        sinceSnapshot++;
+
+        if (depth > 0)
+            unitRecords++;
+        else
+            flushIfDue();
+    }
+
+    void beginUnit() override
+    {
+        depth++;
+    }
+
+    void endUnit() override
+    {
+        if (--depth > 0)
+            return;
+
+        if (unitRecords > 0)
+        {
+            pending.back().continued = false;
+            pending.back().checksum = pending.back().computeChecksum();
+            unitRecords = 0;
+        }
+        flushIfDue();
+    }
+
+    // Makes the buffered records durable, not allowed inside a unit
+    void commit()
+    {
+        if (depth > 0)
+            throw std::runtime_error("Unable to commit the journal inside a command!");
+        if (pending.empty())
+            return;
+
+        auto bytes = std::as_bytes(std::span(pending));
+        if (!writeAll(fd, bytes.data(), bytes.size()) || (fdatasync(fd) != 0))
+            throw std::runtime_error("Unable to write journal " + path);
+        pending.clear();
+        syncs++;
+    }
+
+    // Saves all the balances, then empties the journal they make redundant; not allowed inside a unit
+    void snapshot()
+    {
+        if (depth > 0)
+            throw std::runtime_error("Unable to snapshot the balances inside a command!");
+
+        std::string temporary = snapshotPath + ".tmp";
+        int out = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0)
+            throw std::runtime_error("Unable to create snapshot " + temporary);
+
+        SnapshotHeader header{};
+        memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+        header.sequence = sequence;
+        header.count = accounts.size();
+        std::vector<unsigned> balances;
+        balances.reserve(accounts.size());
+        for (const auto& account : accounts)
+            balances.push_back(account.balance);
+
+        bool success = writeAll(out, &header, sizeof(header))
+                    && writeAll(out, balances.data(), balances.size() * sizeof(unsigned))
+                    && (fsync(out) == 0);
+        close(out);
+        // the rename is atomic: a crash leaves either the old or the new snapshot
+        if (!success || (rename(temporary.c_str(), snapshotPath.c_str()) != 0))
+            throw std::runtime_error("Unable to write snapshot " + snapshotPath);
+        syncDirectory();
+
+        pending.clear();
+        if ((ftruncate(fd, 0) != 0) || (fsync(fd) != 0))
+            throw std::runtime_error("Unable to truncate journal " + path);
+        sinceSnapshot = 0;
+        snapshots++;
+    }
+
+    uint64_t lastSequence() const
+    {
+        return sequence;
+    }
+
+    // Records applied by the replay at construction
+    size_t replayed() const
+    {
+        return replayedRecords;
+    }
+
+    size_t syncCount() const
+    {
+        return syncs;
+    }
+
+    size_t snapshotCount() const
+    {
+        return snapshots;
+    }
+
+private:
+    void flushIfDue()
+    {
+        if (config.snapshotInterval && (sinceSnapshot >= config.snapshotInterval))
+            snapshot();
+        else if (pending.size() >= config.groupSize)
+            commit();
+    }
+
+    static bool writeAll(int file, const void* data, size_t size)
+    {
+        auto bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            ssize_t written = write(file, bytes, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    void loadSnapshot()
+    {
+        int in = open(snapshotPath.c_str(), O_RDONLY);
+        if (in < 0)
+            return; // first start, or never snapshotted
+
+        SnapshotHeader header{};
+        std::vector<unsigned> balances(accounts.size());
+        bool valid = (read(in, &header, sizeof(header)) == sizeof(header))
+                  && (memcmp(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic)) == 0)
+                  && (header.count == accounts.size())
+                  && (read(in, balances.data(), balances.size() * sizeof(unsigned))
+                      == static_cast<ssize_t>(balances.size() * sizeof(unsigned)));
+        close(in);
+        if (!valid)
+            throw std::runtime_error("Invalid snapshot " + snapshotPath);
+
+        for (size_t id = 0; id < accounts.size(); ++id)
+            accounts[id].balance = balances[id];
+        sequence = header.sequence;
+    }
+
+    // Applies the complete units of valid records following the snapshot, then cuts off the rest
+    void replay()
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            throw std::runtime_error("Unable to read journal " + path);
+        size_t size = static_cast<size_t>(st.st_size);
+        size_t validSize = 0;
+
+        if (size >= sizeof(JournalRecord))
+        {
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED)
+                throw std::runtime_error("Unable to map journal " + path);
+            madvise(mapping, size, MADV_SEQUENTIAL);
+
+            std::span records(static_cast<const JournalRecord*>(mapping), size / sizeof(JournalRecord));
+            size_t unitStart = 0; // first record of the unit being read
+            for (size_t i = 0; i < records.size(); ++i)
+            {
+                const JournalRecord& r = records[i];
+                if ((r.checksum != r.computeChecksum()) || (r.account >= accounts.size()))
+                    break;
+                // a gap: what follows cannot be trusted
+                uint64_t expected = sequence + (i - unitStart) + 1;
+                if ((r.sequence > sequence) && (r.sequence != expected))
+                    break;
+                if (r.continued)
+                    continue;
+
+                for (const auto& change : records.subspan(unitStart, i + 1 - unitStart))
+                {
+                    if (change.sequence <= sequence)
+                        continue;
+                    unsigned& balance = accounts[change.account].balance;
+                    if (change.deposit != change.undo)
+                        balance += change.amount;
+                    else
+                        balance -= change.amount;
+                    sequence = change.sequence;
+                    replayedRecords++;
+                    sinceSnapshot++;
+                }
+                unitStart = i + 1;
+                validSize = unitStart * sizeof(JournalRecord);
+            }
+            munmap(mapping, size);
+        }
+
+        if ((validSize != size) && (ftruncate(fd, static_cast<off_t>(validSize)) != 0))
+            throw std::runtime_error("Unable to repair journal " + path);
+    }
+
+    void syncDirectory()
+    {
+        size_t slash = snapshotPath.find_last_of('/');
+        std::string directory = (slash == std::string::npos) ? "." : snapshotPath.substr(0, slash + 1);
+        int dir = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir < 0)
+            return;
+        fsync(dir);
+        close(dir);
+    }
+
+    const std::string path;
+    const std::string snapshotPath;
+    std::span<BankAccount> accounts;
+    const JournalConfig config;
+    int fd {-1};
+
+    std::vector<JournalRecord> pending;
+    size_t depth {0};       // units begun and not ended
+    size_t unitRecords {0}; // pending records of the current unit
+    uint64_t sequence {0};
+    size_t sinceSnapshot {0};
+    size_t replayedRecords {0};
+    size_t syncs {0};
+    size_t snapshots {0};
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Command.h"
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Same behaviour as CompositeBankAccountCommand, with the sub-commands stored inline
+template <size_t N>
+class InlineCompositeCommand
+{
+public:
+    template <typename... COMMANDS>
+        requires (sizeof...(COMMANDS) == N)
+    InlineCompositeCommand(COMMANDS&&... commands_)
+    : commands{std::forward<COMMANDS>(commands_)...}
+    {}
+
+    void call()
+    {
+        runAsUnit(journal(), [this]
+        {
+            for (auto& cmd : commands)
+                cmd.call();
+        });
+    }
+
+    void undo()
+    {
+        runAsUnit(journal(), [this]
+        {
+            for (auto it = commands.rbegin(); it != commands.rend(); ++it)
+                it->undo();
+        });
+    }
+
+    bool isSuccessful() const
+    {
+        for (const auto& cmd : commands)
+            if (!cmd.isSuccessful())
+                return false;
+        return true;
+    }
+
+protected:
+    AccountJournal* journal() const
+    {
+        if constexpr (N > 0)
+            return commands.front().getJournal();
+        return nullptr;
+    }
+
+    std::array<BankAccountCommand, N> commands;
+};
+
+
+// Same behaviour as DependentCompositeCommand
+template <size_t N>
+class InlineDependentCommand : public InlineCompositeCommand<N>
+{
+public:
+    using InlineCompositeCommand<N>::InlineCompositeCommand;
+
+    // Breaks chain if a command fails
+    void call()
+    {
+        runAsUnit(this->journal(), [this]
+        {
+            for (auto& cmd : this->commands)
+            {
+                if (successfulChain)
+                {
+                    cmd.call();
+                    successfulChain = cmd.isSuccessful();
+                }
+            }
+        });
+    }
+
+private:
+    bool successfulChain {true};
+};
+
+
+struct InlineTransferCommand : InlineDependentCommand<2>
+{
+    InlineTransferCommand(BankAccount& from, BankAccount& to, unsigned amount)
+    : InlineDependentCommand<2>{BankAccountCommand{from, BankAccountCommand::Action::withdraw, amount},
+                                BankAccountCommand{to, BankAccountCommand::Action::deposit, amount}}
+    {}
+};
+
+
+/*
+ * Holds any command with call()/undo() by value in a buffer of CAPACITY bytes,
+ * without heap allocation. Movable, not copyable.
+ */
+template <size_t CAPACITY = 96>
+class InlineCommand
+{
+public:
+    template <typename T>
+        requires (!std::is_same_v<std::remove_cvref_t<T>, InlineCommand>)
+    InlineCommand(T&& command)
+    {
+        typedef std::remove_cvref_t<T> Type;
+        static_assert(sizeof(Type) <= CAPACITY, "Command too large for the inline buffer!");
+        static_assert(alignof(Type) <= alignof(std::max_align_t), "Command over-aligned for the inline buffer!");
+        static_assert(std::is_nothrow_move_constructible_v<Type>, "Commands must be nothrow movable!");
+
+        new (storage) Type(std::forward<T>(command));
+        operations = &OPERATIONS<Type>;
+    }
+
+    InlineCommand(InlineCommand&& other) noexcept
+    : operations(other.operations)
+    {
+        operations->move(storage, other.storage);
+    }
+
+    InlineCommand& operator=(InlineCommand&& other) noexcept
+    {
+        if (this != &other)
+        {
+            operations->destroy(storage);
+            operations = other.operations;
+            operations->move(storage, other.storage);
+        }
+        return *this;
+    }
+
+    ~InlineCommand()
+    {
+        operations->destroy(storage);
+    }
+
+    InlineCommand(const InlineCommand&) = delete;
+    InlineCommand& operator=(const InlineCommand&) = delete;
+
+    void call()
+    {
+        operations->call(storage);
+    }
+
+    void undo()
+    {
+        operations->undo(storage);
+    }
+
+    bool isSuccessful() const
+    {
+        return operations->isSuccessful(storage);
+    }
+
+private:
+    struct Operations
+    {
+        void (*call)(void*);
+        void (*undo)(void*);
+        bool (*isSuccessful)(const void*);
+        void (*move)(void* to, void* from); // leaves from alive, in its moved-from state
+        void (*destroy)(void*);
+    };
+
+    // T::call names the function of T itself: no virtual call even if it overrides one
+    template <typename T>
+    static constexpr Operations OPERATIONS =
+    {
+        [](void* p) { static_cast<T*>(p)->T::call(); },
+        [](void* p) { static_cast<T*>(p)->T::undo(); },
+        [](const void* p) { return static_cast<const T*>(p)->T::isSuccessful(); },
+        [](void* to, void* from) { new (to) T(std::move(*static_cast<T*>(from))); },
+        [](void* p) { static_cast<T*>(p)->~T(); }
+    };
+
+    alignas(std::max_align_t) std::byte storage[CAPACITY];
+    const Operations* operations;
+};
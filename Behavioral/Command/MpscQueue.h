@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// Unbounded lock-free queue for many producers and a single consumer (D. Vyukov's design)
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+    : head(&stub)
+    , tail(&stub)
+    {}
+
+    ~MpscQueue()
+    {
+        while (pop())
+            ;
+        if (tail != &stub)
+            delete tail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread
+    void push(T value)
+    {
+        Node* node = new Node{std::move(value)};
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release); // links the node for the consumer
+    }
+
+    // Consumer thread only. Empty if the queue is empty, or a push is half done.
+    std::optional<T> pop()
+    {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return std::nullopt;
+
+        std::optional<T> value(std::move(*next->value));
+        next->value.reset(); // next becomes the new stub
+        if (tail != &stub)
+            delete tail;
+        tail = next;
+        return value;
+    }
+
+private:
+    struct Node
+    {
+        std::optional<T> value;
+        std::atomic<Node*> next {nullptr};
+    };
+
+    Node stub;
+    std::atomic<Node*> head; // last pushed node
+    Node* tail;              // already consumed node, its next is the front
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Command.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Accounts partitioned into shards, each with its own lock: commands locking
+ * their shards in increasing order run in parallel on different shards.
+ */
+class ShardedLedger
+{
+public:
+    ShardedLedger(size_t accountCount, unsigned initialBalance, size_t shardCount = 1024)
+    : shards(shardCount)
+    {
+        accounts.reserve(accountCount);
+        for (size_t id = 0; id < accountCount; ++id)
+            accounts.emplace_back("account " + std::to_string(id), initialBalance);
+    }
+
+    BankAccount& account(size_t id)
+    {
+        return accounts[id];
+    }
+
+    size_t size() const
+    {
+        return accounts.size();
+    }
+
+    // Runs cmd, which must only touch the accounts listed in ids
+    template <size_t N>
+    void execute(Command& cmd, const std::array<size_t, N>& ids)
+    {
+        auto locks = lockShards(ids);
+        cmd.call();
+    }
+
+    template <size_t N>
+    void undo(Command& cmd, const std::array<size_t, N>& ids)
+    {
+        auto locks = lockShards(ids);
+        cmd.undo();
+    }
+
+    bool transfer(size_t from, size_t to, unsigned amount)
+    {
+        BankTransferCommand cmd(accounts[from], accounts[to], amount);
+        execute(cmd, std::array{from, to});
+        return cmd.isSuccessful();
+    }
+
+    // Sum of all balances, locking every shard for a consistent view
+    uint64_t totalBalance()
+    {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for (auto& shard : shards)
+            locks.emplace_back(shard.mutex);
+
+        uint64_t total = 0;
+        for (const auto& a : accounts)
+            total += a.getBalance();
+        return total;
+    }
+
+private:
+    struct alignas(64) Shard // one cache line each: no false sharing between locks
+    {
+        std::mutex mutex;
+    };
+
+    template <size_t N>
+    std::array<std::unique_lock<std::mutex>, N> lockShards(const std::array<size_t, N>& ids)
+    {
+        std::array<size_t, N> order;
+        for (size_t i = 0; i < N; ++i)
+            order[i] = ids[i] % shards.size();
+        std::sort(order.begin(), order.end());
+
+        std::array<std::unique_lock<std::mutex>, N> locks;
+        for (size_t i = 0; i < N; ++i)
+            if ((i == 0) || (order[i] != order[i - 1]))
+                locks[i] = std::unique_lock(shards[order[i]].mutex);
+        return locks;
+    }
+
+    std::vector<BankAccount> accounts;
+    std::vector<Shard> shards;
+};
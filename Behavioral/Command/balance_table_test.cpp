@@ -0,0 +1,111 @@
+// Checks that the batched balance table gives the same results as the commands run one by one
+#include "BalanceTable.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+CommandBatch randomBatch(std::mt19937& random, size_t accounts, size_t commands, unsigned maxAmount)
+{
+    std::uniform_int_distribution<uint32_t> id(0, static_cast<uint32_t>(accounts - 1));
+    std::uniform_int_distribution<unsigned> amount(1, maxAmount);
+    std::bernoulli_distribution withdrawal(0.6);
+    CommandBatch batch;
+    for (size_t i = 0; i < commands; ++i)
+        batch.add(id(random), withdrawal(random) ? BankAccountCommand::Action::withdraw : BankAccountCommand::Action::deposit, amount(random));
+    return batch;
+}
+
+bool sameBalances(const BalanceTable& a, const BalanceTable& b)
+{
+    for (size_t id = 0; id < a.size(); ++id)
+        if (a.balance(id) != b.balance(id))
+            return false;
+    return true;
+}
+
+// Applies batches with both methods, several times so the scratch buffers are reused
+bool agree(size_t accounts, size_t commands, unsigned maxAmount, unsigned seed)
+{
+    std::mt19937 random(seed);
+    BalanceTable batched(accounts, 100);
+    BalanceTable scalar(accounts, 100);
+    std::vector<uint8_t> batchedSuccess;
+    std::vector<uint8_t> scalarSuccess;
+    for (int round = 0; round < 20; ++round)
+    {
+        CommandBatch batch = randomBatch(random, accounts, commands, maxAmount);
+        batched.apply(batch, batchedSuccess);
+        scalar.applyScalar(batch, scalarSuccess);
+        if ((batchedSuccess != scalarSuccess) || !sameBalances(batched, scalar))
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    BalanceTable table(3, 50);
+    std::vector<uint8_t> success {1, 1};
+    table.apply(CommandBatch{}, success);
+    check(success.empty() && (table.balance(0) == 50), "empty batch");
+
+    // the withdrawal only succeeds after the deposit of the same batch
+    CommandBatch ordered;
+    ordered.add(1, BankAccountCommand::Action::withdraw, 80);
+    ordered.add(1, BankAccountCommand::Action::deposit, 40);
+    ordered.add(1, BankAccountCommand::Action::withdraw, 80);
+    ordered.add(2, BankAccountCommand::Action::withdraw, 50);
+    table.apply(ordered, success);
+    check((success == std::vector<uint8_t>{0, 1, 1, 1}), "commands of an overdrawn account replayed in order");
+    check((table.balance(0) == 50) && (table.balance(1) == 10) && (table.balance(2) == 0), "balances after the batch");
+
+    // few accounts, every one touched: the overdraft check runs over the whole table
+    check(agree(16, 256, 150, 1), "dense batches, with overdrafts");
+    check(agree(16, 256, 20, 2), "dense batches, small amounts");
+    // many accounts, few touched: only those are checked
+    check(agree(4096, 64, 150, 3), "sparse batches, with overdrafts");
+    check(agree(4096, 1, 150, 4), "single command batches");
+
+    CommandBatch unknown;
+    unknown.add(3, BankAccountCommand::Action::deposit, 1);
+    bool thrown = false;
+    try
+    {
+        table.apply(unknown, success);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "unknown account refused");
+
+    CommandBatch inconsistent;
+    inconsistent.add(0, BankAccountCommand::Action::deposit, 1);
+    inconsistent.amounts.push_back(2);
+    thrown = false;
+    try
+    {
+        table.applyScalar(inconsistent, success);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown && (table.balance(0) == 50), "inconsistent batch refused");
+
+    std::cout << (failures ? "Balance table test failed!" : "Balance table test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -1,174 +1,6 @@
-#include <iostream>
-#include <string>
-#include <vector>
-
-class BankAccount
-{
-    friend class BankAccountCommand;
-public:
-    explicit BankAccount(const std::string& name_)
-    : name(name_)
-    {}
-
-    BankAccount(const std::string& name_, unsigned initial_amount)
-    : name(name_)
-    , balance(initial_amount)
-    {}
-
-    void printStats() const
-    {
-        std::cout << "Account \"" << name << "\" - Balance: " << balance << " EUR" << std::endl;
-    }
-
-private:
-    void deposit(unsigned amount)
-    {
-        balance += amount;
-    }
-
-    bool withdraw(unsigned amount)
-    {
-        if (balance >= amount)
-        {
-            balance -= amount;
-            return true;
-        }
-        return false;
-    }
-
-    const std::string name;
-    unsigned balance {0};
-};
-
-
-struct Command
-{
-    virtual void call() = 0;
-    virtual void undo() = 0;
-    virtual ~Command() = default;
-};
-
-
-class BankAccountCommand : public Command
-{
-public:
-    enum class Action
-    {
-        deposit,
-        withdraw
-    };
-
-    BankAccountCommand(BankAccount& ba, Action action_, unsigned amount_)
-    : account(ba)
-    , action(action_)
-    , amount(amount_)
-    {}
-
-    void call() override
-    {
-        switch (action)
-        {
-        case Action::deposit:
-            account.deposit(amount);
-            successfulAction = true;
-            break;
-
-        case Action::withdraw:
-            successfulAction = account.withdraw(amount);
-            break;
-
-        default:
-            break;
-        }
-    }
-
-    void undo() override
-    {
-        if (undoneAction || !successfulAction)
-            return;
-
-        undoneAction = true;
-        switch (action)
-        {
-        case Action::deposit:
-            account.withdraw(amount);
-            break;
-
-        case Action::withdraw:
-            if (successfulAction)
-                account.deposit(amount);
-            break;
-
-        default:
-            undoneAction = false;
-            break;
-        }
-    }
-
-    bool isSuccessful() const
-    {
-        return successfulAction;
-    }
-
-private:
-    BankAccount& account;
-    const Action action;
-    bool successfulAction {false};
-    bool undoneAction {false};
-    const unsigned amount;
-};
-
-
-struct CompositeBankAccountCommand : std::vector<BankAccountCommand>, Command
-{
-    CompositeBankAccountCommand(const std::initializer_list<value_type>& items)
-    : std::vector<BankAccountCommand>(items)
-    {}
-
-    void call() override
-    {
-        for (auto& cmd : *this)
-            cmd.call();
-    }
-
-    void undo() override
-    {
-        for (auto it = rbegin(); it != rend(); ++it)
-            it->undo();
-    }
-};
-
-
-struct DependentCompositeCommand : CompositeBankAccountCommand
-{
-    using CompositeBankAccountCommand::CompositeBankAccountCommand;
-
-    // Breakes chain if a command fails
-    void call() override
-    {
-        for (auto& cmd : *this)
-        {
-            if (successfulChain)
-            {
-                cmd.call();
-                successfulChain = cmd.isSuccessful();
-            }
-        }
-    }
-
-private:
-    bool successfulChain {true};
-};
-
-
-struct BankTransferCommand : DependentCompositeCommand
-{
-    BankTransferCommand(BankAccount& from, BankAccount& to, unsigned amount)
-    : DependentCompositeCommand{BankAccountCommand{from, BankAccountCommand::Action::withdraw, amount},
-                                  BankAccountCommand{to, BankAccountCommand::Action::deposit, amount}}
-    {}
-};
+#include "Command.h"
 
+#include <iostream>
 
 int main(int argc, const char* argv[])
 {
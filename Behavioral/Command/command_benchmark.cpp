@@ -0,0 +1,269 @@
+// Throughput of the command implementations. Build with -DCMAKE_BUILD_TYPE=Release
+// to get meaningful numbers.
+#include "BalanceTable.h"
+#include "Command.h"
+#include "CommandExecutor.h"
+#include "InlineCommand.h"
+#include "ShardedLedger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every heap allocation of the program is counted. Not inlined: GCC would
+// otherwise pair malloc and free with new and delete and warn about a mismatch.
+std::atomic<size_t> allocations {0};
+
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+[[gnu::noinline]] void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// Builds and runs a transfer between random accounts per iteration, with the given command storage
+template <typename MAKE_AND_RUN>
+void benchmarkTransfers(const char* name, std::vector<BankAccount>& accounts, size_t count, MAKE_AND_RUN makeAndRun)
+{
+    std::mt19937 rng(1);
+    size_t before = allocations.load();
+    size_t successful = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i)
+        successful += makeAndRun(accounts[rng() % accounts.size()], accounts[rng() % accounts.size()], rng() % 150);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << name << ": " << static_cast<uint64_t>(count / elapsed.count()) << " transfers/sec, "
+              << static_cast<double>(allocations.load() - before) / count << " allocations/transfer ("
+              << successful << " successful)" << std::endl;
+}
+
+// Producers submitting deposits to the executor, each on its own account
+void benchmarkExecutor(unsigned producers, size_t commandsPerProducer, bool futurePerCommand)
+{
+    std::vector<BankAccount> accounts;
+    for (unsigned p = 0; p < producers; ++p)
+        accounts.emplace_back("producer " + std::to_string(p));
+
+    std::vector<std::vector<BankAccountCommand>> commands(producers);
+    for (unsigned p = 0; p < producers; ++p)
+    {
+        commands[p].reserve(commandsPerProducer);
+        for (size_t i = 0; i < commandsPerProducer; ++i)
+            commands[p].emplace_back(accounts[p], BankAccountCommand::Action::deposit, 1);
+    }
+
+    CommandExecutor executor;
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+            {
+                std::vector<std::future<bool>> results;
+                for (size_t i = 0; i + 1 < commandsPerProducer; ++i)
+                {
+                    if (futurePerCommand)
+                        results.push_back(executor.submit(commands[p][i]));
+                    else
+                        executor.post(commands[p][i]);
+                }
+                executor.submit(commands[p].back()).wait(); // commands run in order: all done
+            });
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << producers << " producers" << (futurePerCommand ? " (future per command)" : "") << ": "
+              << static_cast<uint64_t>(producers * commandsPerProducer / elapsed.count()) << " commands/sec" << std::endl;
+}
+
+// Random transfers between a million accounts, from several threads
+void benchmarkShardedLedger(ShardedLedger& ledger, unsigned threads, size_t transfersPerThread)
+{
+    uint64_t before = ledger.totalBalance();
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]
+            {
+                std::mt19937_64 rng(t);
+                for (size_t i = 0; i < transfersPerThread; ++i)
+                    ledger.transfer(rng() % ledger.size(), rng() % ledger.size(), rng() % 150);
+            });
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << threads << " threads: " << static_cast<uint64_t>(threads * transfersPerThread / elapsed.count())
+              << " transfers/sec, total balance " << (ledger.totalBalance() == before ? "preserved" : "CHANGED") << std::endl;
+}
+
+// A day of deposits and withdrawals: one command at a time on BankAccount objects, then in batch
+void benchmarkBatch(size_t accountCount, size_t commandCount, unsigned initialBalance)
+{
+    std::mt19937 rng(3);
+    CommandBatch batch;
+    for (size_t i = 0; i < commandCount; ++i)
+    {
+        auto action = (rng() % 2) ? BankAccountCommand::Action::withdraw : BankAccountCommand::Action::deposit;
+        batch.add(static_cast<uint32_t>(rng() % accountCount), action, rng() % 100);
+    }
+
+    std::vector<BankAccount> accounts;
+    accounts.reserve(accountCount);
+    for (size_t id = 0; id < accountCount; ++id)
+        accounts.emplace_back("account " + std::to_string(id), initialBalance);
+    std::vector<BankAccountCommand> commands;
+    commands.reserve(commandCount);
+    for (size_t i = 0; i < commandCount; ++i)
+        commands.emplace_back(accounts[batch.accounts[i]], batch.withdrawals[i] ? BankAccountCommand::Action::withdraw
+                                                                                 : BankAccountCommand::Action::deposit, batch.amounts[i]);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& cmd : commands)
+        cmd.call();
+    std::chrono::duration<double> objectsTime = std::chrono::steady_clock::now() - start;
+
+    BalanceTable scalarTable(accountCount, initialBalance);
+    std::vector<uint8_t> scalarSuccess;
+    start = std::chrono::steady_clock::now();
+    scalarTable.applyScalar(batch, scalarSuccess);
+    std::chrono::duration<double> scalarTime = std::chrono::steady_clock::now() - start;
+
+    BalanceTable table(accountCount, initialBalance);
+    std::vector<uint8_t> success;
+    start = std::chrono::steady_clock::now();
+    table.apply(batch, success);
+    std::chrono::duration<double> batchTime = std::chrono::steady_clock::now() - start;
+
+    bool identical = (success == scalarSuccess);
+    for (size_t i = 0; i < commandCount; ++i)
+        identical = identical && (commands[i].isSuccessful() == static_cast<bool>(success[i]));
+    for (size_t id = 0; id < accountCount; ++id)
+        identical = identical && (accounts[id].getBalance() == table.balance(id));
+
+    std::cout << "  " << accountCount << " accounts of " << initialBalance << ": BankAccountCommand " << static_cast<uint64_t>(commandCount / objectsTime.count())
+              << ", table scalar " << static_cast<uint64_t>(commandCount / scalarTime.count())
+              << ", table batch " << static_cast<uint64_t>(commandCount / batchTime.count()) << " commands/sec, results "
+              << (identical ? "identical" : "DIFFERENT") << std::endl;
+}
+
+// Many small batches on a large table: apply() must cost what the batch touches
+void benchmarkSmallBatches(size_t accountCount, size_t batchSize, size_t batchCount)
+{
+    std::mt19937 rng(4);
+    std::vector<CommandBatch> batches(batchCount);
+    for (auto& batch : batches)
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            auto action = (rng() % 2) ? BankAccountCommand::Action::withdraw : BankAccountCommand::Action::deposit;
+            batch.add(static_cast<uint32_t>(rng() % accountCount), action, rng() % 100);
+        }
+
+    BalanceTable scalarTable(accountCount, 50);
+    std::vector<uint8_t> success;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& batch : batches)
+        scalarTable.applyScalar(batch, success);
+    std::chrono::duration<double> scalarTime = std::chrono::steady_clock::now() - start;
+
+    BalanceTable table(accountCount, 50);
+    start = std::chrono::steady_clock::now();
+    for (const auto& batch : batches)
+        table.apply(batch, success);
+    std::chrono::duration<double> batchTime = std::chrono::steady_clock::now() - start;
+
+    bool identical = true;
+    for (size_t id = 0; id < accountCount; ++id)
+        identical = identical && (scalarTable.balance(id) == table.balance(id));
+
+    size_t commandCount = batchSize * batchCount;
+    std::cout << "  " << accountCount << " accounts, batches of " << batchSize << ": table scalar "
+              << static_cast<uint64_t>(commandCount / scalarTime.count()) << ", table batch "
+              << static_cast<uint64_t>(commandCount / batchTime.count()) << " commands/sec, results "
+              << (identical ? "identical" : "DIFFERENT") << std::endl;
+}
+
+int main()
+{
+    std::cout << "Batch of 4M deposits/withdrawals:" << std::endl;
+    for (size_t accountCount : {100, 10'000, 1'000'000})
+        benchmarkBatch(accountCount, 4'000'000, 50);
+    // overdrafts are rare
+    for (size_t accountCount : {10'000, 1'000'000})
+        benchmarkBatch(accountCount, 4'000'000, 100'000);
+    benchmarkSmallBatches(1'000'000, 100, 20'000);
+
+    std::cout << "Command storage, transfers between 1000 accounts:" << std::endl;
+    std::vector<BankAccount> accounts;
+    accounts.reserve(1000);
+    for (int id = 0; id < 1000; ++id)
+        accounts.emplace_back("account " + std::to_string(id), 100);
+
+    benchmarkTransfers("BankTransferCommand", accounts, 5'000'000, [](BankAccount& from, BankAccount& to, unsigned amount)
+    {
+        BankTransferCommand cmd(from, to, amount);
+        Command& command = cmd; // as stored by a generic caller
+        command.call();
+        return command.isSuccessful();
+    });
+    benchmarkTransfers("InlineTransferCommand", accounts, 5'000'000, [](BankAccount& from, BankAccount& to, unsigned amount)
+    {
+        InlineTransferCommand cmd(from, to, amount);
+        cmd.call();
+        return cmd.isSuccessful();
+    });
+    benchmarkTransfers("InlineCommand<>", accounts, 5'000'000, [](BankAccount& from, BankAccount& to, unsigned amount)
+    {
+        InlineCommand<> command(InlineTransferCommand(from, to, amount));
+        command.call();
+        return command.isSuccessful();
+    });
+
+    std::cout << "Command executor:" << std::endl;
+    for (unsigned producers : {1, 2, 4, 8, 16})
+        benchmarkExecutor(producers, 1'000'000 / producers, false);
+    benchmarkExecutor(4, 250'000, true);
+
+    std::cout << "Sharded ledger, 1M accounts (hardware threads: " << std::thread::hardware_concurrency() << "):" << std::endl;
+    ShardedLedger ledger(1'000'000, 100);
+    for (unsigned threads : {1, 2, 4, 8, 16})
+        benchmarkShardedLedger(ledger, threads, 2'000'000 / threads);
+}
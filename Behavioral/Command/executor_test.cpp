@@ -0,0 +1,100 @@
+// Checks the lock-free queue and the command executor
+#include "Command.h"
+#include "CommandExecutor.h"
+#include "MpscQueue.h"
+
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Records the order in which it runs
+struct OrderCommand : Command
+{
+    OrderCommand(std::vector<int>& log_, int value_)
+    : log(log_)
+    , value(value_)
+    {}
+
+    void call() override { log.push_back(value); }
+    void undo() override {}
+
+    std::vector<int>& log;
+    int value;
+};
+
+int main()
+{
+    {
+        MpscQueue<std::unique_ptr<int>> queue;
+        check(!queue.pop(), "empty queue");
+        for (int i = 0; i < 3; ++i)
+            queue.push(std::make_unique<int>(i));
+        auto first = queue.pop();
+        check(first && (**first == 0), "first in, first out");
+        check((**queue.pop() == 1) && (**queue.pop() == 2) && !queue.pop(), "queue drained in order");
+        queue.push(std::make_unique<int>(3)); // freed by the destructor
+    }
+
+    constexpr int PRODUCERS = 4;
+    constexpr int COMMANDS = 2000;
+    BankAccount account("Test", 0);
+    {
+        CommandExecutor executor;
+        std::vector<std::vector<BankAccountCommand>> deposits(PRODUCERS);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p)
+        {
+            deposits[p].reserve(COMMANDS);
+            for (int i = 0; i < COMMANDS; ++i)
+                deposits[p].emplace_back(account, BankAccountCommand::Action::deposit, 1);
+        }
+        for (int p = 0; p < PRODUCERS; ++p)
+            producers.emplace_back([&executor, &commands = deposits[p]]
+            {
+                for (auto& cmd : commands)
+                    executor.post(cmd);
+            });
+        for (auto& t : producers)
+            t.join();
+
+        BankAccountCommand tooMuch(account, BankAccountCommand::Action::withdraw, PRODUCERS * COMMANDS + 1);
+        check(!executor.submit(tooMuch).get(), "failed command reported by its future");
+        BankAccountCommand all(account, BankAccountCommand::Action::withdraw, PRODUCERS * COMMANDS);
+        check(executor.submit(all).get(), "command executed after all the posted ones");
+        check(executor.executed() == PRODUCERS * COMMANDS + 2, "executed count");
+
+        std::vector<int> log;
+        std::vector<OrderCommand> ordered;
+        for (int i = 0; i < 100; ++i)
+            ordered.emplace_back(log, i);
+        std::future<bool> last;
+        for (auto& cmd : ordered)
+            last = executor.submit(cmd);
+        last.get();
+        bool inOrder = (log.size() == ordered.size());
+        for (size_t i = 0; inOrder && (i < log.size()); ++i)
+            inOrder = (log[i] == static_cast<int>(i));
+        check(inOrder, "commands executed in submission order");
+    }
+    check(account.getBalance() == 0, "balance after the executor stopped");
+
+    {
+        CommandExecutor idle; // stops without having run anything
+    }
+
+    std::cout << (failures ? "Executor test failed!" : "Executor test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
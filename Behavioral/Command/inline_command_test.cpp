@@ -0,0 +1,109 @@
+// Checks the inline composite commands and the type-erased inline command
+#include "Command.h"
+#include "InlineCommand.h"
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Counts the live instances, to check the buffer's lifetime management
+struct CountingCommand
+{
+    CountingCommand(int& calls_, int& alive_)
+    : calls(&calls_)
+    , alive(&alive_)
+    {
+        (*alive)++;
+    }
+
+    CountingCommand(CountingCommand&& other) noexcept
+    : calls(other.calls)
+    , alive(other.alive)
+    {
+        (*alive)++;
+    }
+
+    ~CountingCommand()
+    {
+        (*alive)--;
+    }
+
+    void call() { (*calls)++; }
+    void undo() { (*calls)--; }
+    bool isSuccessful() const { return true; }
+
+    int* calls;
+    int* alive;
+};
+
+int main()
+{
+    BankAccount a("A", 100);
+    BankAccount b("B", 0);
+
+    InlineTransferCommand transfer(a, b, 60);
+    transfer.call();
+    check(transfer.isSuccessful() && (a.getBalance() == 40) && (b.getBalance() == 60), "transfer");
+    transfer.undo();
+    check((a.getBalance() == 100) && (b.getBalance() == 0), "transfer undone");
+
+    InlineTransferCommand overdraft(a, b, 150);
+    overdraft.call();
+    check(!overdraft.isSuccessful() && (a.getBalance() == 100) && (b.getBalance() == 0), "chain broken by the withdrawal");
+    overdraft.undo();
+    check((a.getBalance() == 100) && (b.getBalance() == 0), "failed transfer undone");
+
+    // the independent composite runs every command, even after a failure
+    InlineCompositeCommand<2> both(BankAccountCommand{b, BankAccountCommand::Action::withdraw, 10},
+                                   BankAccountCommand{a, BankAccountCommand::Action::deposit, 10});
+    both.call();
+    check(!both.isSuccessful() && (a.getBalance() == 110) && (b.getBalance() == 0), "composite keeps going");
+    both.undo();
+    check((a.getBalance() == 100) && (b.getBalance() == 0), "composite undone");
+
+    InlineCompositeCommand<0> none;
+    none.call();
+    check(none.isSuccessful(), "empty composite");
+
+    // type erasure: the stored command keeps its state through moves
+    InlineCommand<> erased(InlineTransferCommand(a, b, 25));
+    erased.call();
+    check(erased.isSuccessful() && (a.getBalance() == 75), "erased transfer");
+    InlineCommand<> moved(std::move(erased));
+    moved.undo();
+    check(moved.isSuccessful() && (a.getBalance() == 100) && (b.getBalance() == 0), "undone after a move");
+
+    int calls = 0;
+    int alive = 0;
+    {
+        std::vector<InlineCommand<>> queue;
+        for (int i = 0; i < 20; ++i) // reallocations move the buffers
+            queue.emplace_back(CountingCommand(calls, alive));
+        check(alive == 20, "one instance per command after moves");
+        for (auto& cmd : queue)
+            cmd.call();
+        check(calls == 20, "every command called");
+
+        queue.front() = BankAccountCommand{a, BankAccountCommand::Action::deposit, 5};
+        check(alive == 19, "move assignment destroys the replaced command");
+        queue.front().call();
+        check(a.getBalance() == 105, "command of another type after move assignment");
+        queue[1] = std::move(queue[2]);
+        check(alive == 19, "move assignment between commands of the same type");
+    }
+    check(alive == 0, "all commands destroyed");
+
+    std::cout << (failures ? "Inline command test failed!" : "Inline command test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
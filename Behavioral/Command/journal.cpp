@@ -0,0 +1,135 @@
+// Journaled bank: runs random transfers, then recovers the balances from disk.
+//   commandJournal [journal path] [group size]
+#include "Command.h"
+#include "CommandJournal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr size_t ACCOUNTS = 10'000;
+constexpr unsigned INITIAL_BALANCE = 100;
+
+std::vector<BankAccount> openBank()
+{
+    std::vector<BankAccount> accounts;
+    accounts.reserve(ACCOUNTS);
+    for (size_t id = 0; id < ACCOUNTS; ++id)
+        accounts.emplace_back("account " + std::to_string(id), INITIAL_BALANCE);
+    return accounts;
+}
+
+uint64_t totalBalance(const std::vector<BankAccount>& accounts)
+{
+    uint64_t total = 0;
+    for (const auto& account : accounts)
+        total += account.getBalance();
+    return total;
+}
+
+size_t countMismatches(const std::vector<BankAccount>& accounts, const std::vector<unsigned>& expected)
+{
+    size_t mismatches = 0;
+    for (size_t id = 0; id < ACCOUNTS; ++id)
+        mismatches += (accounts[id].getBalance() != expected[id]);
+    return mismatches;
+}
+
+// Transfers between random accounts, undoing one out of ten
+void runTransfers(std::vector<BankAccount>& accounts, size_t count, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    for (size_t i = 0; i < count; ++i)
+    {
+        BankTransferCommand transfer(accounts[rng() % ACCOUNTS], accounts[rng() % ACCOUNTS], rng() % 150);
+        transfer.call();
+        if (rng() % 10 == 0)
+            transfer.undo();
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string path = (argc > 1) ? argv[1] : "bank.journal";
+    JournalConfig config;
+    config.groupSize = (argc > 2) ? std::stoul(argv[2]) : 256;
+    config.snapshotInterval = 1'000'000;
+    std::remove(path.c_str());
+    std::remove((path + ".snapshot").c_str());
+
+    constexpr size_t TRANSFERS = 1'500'000;
+    std::vector<unsigned> expected;
+    {
+        auto accounts = openBank();
+        CommandJournal journal(path, accounts, config);
+
+        auto start = std::chrono::steady_clock::now();
+        runTransfers(accounts, TRANSFERS, 42);
+        journal.commit();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << TRANSFERS << " transfers, " << journal.lastSequence() << " records in " << elapsed.count() << " s: "
+                  << static_cast<uint64_t>(journal.lastSequence() / elapsed.count()) << " records/sec, "
+                  << journal.syncCount() << " syncs, " << journal.snapshotCount() << " snapshots" << std::endl;
+
+        for (const auto& account : accounts)
+            expected.push_back(account.getBalance());
+    }
+
+    // A crash in the middle of a write leaves half a record at the end
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+    const char torn[10] = {};
+    if ((fd < 0) || (write(fd, torn, sizeof(torn)) != sizeof(torn)))
+        std::cout << "Unable to simulate a torn write" << std::endl;
+    close(fd);
+
+    size_t mismatches = 0;
+    {
+        auto accounts = openBank();
+        auto start = std::chrono::steady_clock::now();
+        CommandJournal journal(path, accounts, config);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        mismatches += countMismatches(accounts, expected);
+        std::cout << "Recovered from snapshot + " << journal.replayed() << " records in " << elapsed.count() << " s: "
+                  << mismatches << " mismatching balances, total balance " << totalBalance(accounts)
+                  << " (expected " << ACCOUNTS * INITIAL_BALANCE << ")" << std::endl;
+
+        // The journal goes on from where it stopped
+        runTransfers(accounts, 1000, 7);
+        std::cout << "Last sequence after 1000 more transfers: " << journal.lastSequence() << std::endl;
+
+        expected.clear();
+        for (const auto& account : accounts)
+            expected.push_back(account.getBalance());
+
+        // One last transfer, from the richest account so that both halves are recorded
+        auto richest = std::max_element(accounts.begin(), accounts.end(),
+                                        [](const auto& a, const auto& b) { return a.getBalance() < b.getBalance(); });
+        BankTransferCommand transfer(*richest, accounts[0], richest->getBalance());
+        transfer.call();
+    }
+
+    // A crash during the write of a group leaves any prefix of it: here the
+    // withdrawal of the last transfer, without its deposit
+    struct stat st;
+    if ((stat(path.c_str(), &st) != 0) || (truncate(path.c_str(), st.st_size - sizeof(JournalRecord)) != 0))
+        std::cout << "Unable to simulate a crash inside a transfer" << std::endl;
+
+    auto accounts = openBank();
+    CommandJournal journal(path, accounts, config);
+    size_t halfMismatches = countMismatches(accounts, expected);
+    std::cout << "Recovered from a crash inside a transfer: " << halfMismatches
+              << " mismatching balances, total balance " << totalBalance(accounts)
+              << " (expected " << ACCOUNTS * INITIAL_BALANCE << ")" << std::endl;
+    return (mismatches + halfMismatches) ? 1 : 0;
+}
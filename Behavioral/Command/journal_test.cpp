@@ -0,0 +1,141 @@
+// Checks the recovery of the balances from the journal, after clean and torn shutdowns
+#include "Command.h"
+#include "CommandJournal.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+std::vector<BankAccount> openBank()
+{
+    std::vector<BankAccount> accounts;
+    for (int id = 0; id < 4; ++id)
+        accounts.emplace_back("account " + std::to_string(id), 100);
+    return accounts;
+}
+
+std::vector<unsigned> balances(const std::vector<BankAccount>& accounts)
+{
+    std::vector<unsigned> result;
+    for (const auto& account : accounts)
+        result.push_back(account.getBalance());
+    return result;
+}
+
+// Balances recovered by a new journal on the same files
+std::vector<unsigned> recover(const std::string& path, size_t* replayed = nullptr)
+{
+    auto accounts = openBank();
+    CommandJournal journal(path, accounts);
+    if (replayed)
+        *replayed = journal.replayed();
+    return balances(accounts);
+}
+
+int main()
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "journal_test.log").string();
+    const std::string snapshotPath = path + ".snapshot";
+    std::remove(path.c_str());
+    std::remove(snapshotPath.c_str());
+
+    size_t replayed = 1;
+    check(recover(path, &replayed) == std::vector<unsigned>(4, 100), "empty journal");
+    check(replayed == 0, "nothing replayed from an empty journal");
+
+    std::vector<unsigned> expected;
+    std::vector<unsigned> beforeLast;
+    {
+        auto accounts = openBank();
+        CommandJournal journal(path, accounts, JournalConfig{4, 0});
+        BankTransferCommand first(accounts[0], accounts[1], 30);
+        first.call();
+        BankTransferCommand refused(accounts[2], accounts[3], 500);
+        refused.call();
+        BankTransferCommand undone(accounts[1], accounts[2], 50);
+        undone.call();
+        undone.undo();
+        BankAccountCommand deposit(accounts[3], BankAccountCommand::Action::deposit, 7);
+        deposit.call();
+        beforeLast = balances(accounts);
+        BankTransferCommand last(accounts[3], accounts[0], 20);
+        last.call();
+        expected = balances(accounts);
+
+        journal.beginUnit();
+        bool thrown = false;
+        try
+        {
+            journal.commit();
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        journal.endUnit();
+        check(thrown, "commit refused inside a unit");
+    }
+    check(recover(path, &replayed) == expected, "clean shutdown");
+    check(replayed == 9, "records replayed");
+    const auto fullSize = std::filesystem::file_size(path);
+
+    // torn write of the next record
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.write("torn", 4);
+    }
+    check(recover(path) == expected, "torn record ignored");
+    check(std::filesystem::file_size(path) == fullSize, "torn record truncated");
+
+    // the crash happened between the two halves of the last transfer
+    std::filesystem::resize_file(path, fullSize - sizeof(JournalRecord));
+    check(recover(path, &replayed) == beforeLast, "incomplete unit discarded");
+    check(replayed == 7, "records of complete units replayed");
+    check(std::filesystem::file_size(path) == fullSize - 2 * sizeof(JournalRecord), "incomplete unit truncated");
+
+    // corrupted record: the replay stops before it
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(2 * sizeof(JournalRecord) + offsetof(JournalRecord, amount)));
+        file.put('\x7F');
+    }
+    check(recover(path, &replayed) == std::vector<unsigned>({70, 130, 100, 100}), "replay stops at a corrupted record");
+    check(replayed == 2, "records before the corrupted one replayed");
+
+    // snapshots: the journal starts over, the balances survive
+    std::remove(path.c_str());
+    {
+        auto accounts = openBank();
+        CommandJournal journal(path, accounts, JournalConfig{2, 8});
+        for (int i = 0; i < 10; ++i)
+        {
+            BankTransferCommand transfer(accounts[i % 4], accounts[(i + 1) % 4], 5 + i);
+            transfer.call();
+        }
+        check(journal.snapshotCount() > 0, "snapshots taken");
+        expected = balances(accounts);
+    }
+    check(recover(path, &replayed) == expected, "recovered from snapshot and journal");
+    check(replayed < 20, "records in the snapshot not replayed");
+
+    std::remove(path.c_str());
+    std::remove(snapshotPath.c_str());
+    std::cout << (failures ? "Journal test failed!" : "Journal test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,61 @@
+// Checks that concurrent transfers on a sharded ledger keep the money consistent
+#include "ShardedLedger.h"
+
+#include <array>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    ShardedLedger ledger(4, 100, 4);
+    check(!ledger.transfer(0, 1, 101), "overdraft refused");
+    check((ledger.account(0).getBalance() == 100) && (ledger.account(1).getBalance() == 100), "refused transfer changes nothing");
+    check(ledger.transfer(0, 0, 100) && (ledger.account(0).getBalance() == 100), "transfer to the same account");
+
+    BankTransferCommand cmd(ledger.account(2), ledger.account(3), 40);
+    ledger.execute(cmd, std::array<size_t, 2>{2, 3});
+    check(cmd.isSuccessful() && (ledger.account(3).getBalance() == 140), "executed command");
+    ledger.undo(cmd, std::array<size_t, 2>{2, 3});
+    check((ledger.account(2).getBalance() == 100) && (ledger.account(3).getBalance() == 100), "undone command");
+
+    // few shards: most transfers share a lock, in both orders, and some a single shard
+    constexpr size_t ACCOUNTS = 64;
+    constexpr unsigned THREADS = 4;
+    constexpr unsigned TRANSFERS = 20000;
+    ShardedLedger shared(ACCOUNTS, 1000, 3);
+    std::vector<std::thread> threads;
+    std::vector<unsigned> succeeded(THREADS);
+    for (unsigned t = 0; t < THREADS; ++t)
+        threads.emplace_back([&shared, &succeeded, t]
+        {
+            std::mt19937 random(t);
+            std::uniform_int_distribution<size_t> id(0, ACCOUNTS - 1);
+            std::uniform_int_distribution<unsigned> amount(1, 1500);
+            for (unsigned i = 0; i < TRANSFERS; ++i)
+                succeeded[t] += shared.transfer(id(random), id(random), amount(random));
+        });
+    for (auto& t : threads)
+        t.join();
+
+    unsigned total = 0;
+    for (unsigned s : succeeded)
+        total += s;
+    check(shared.totalBalance() == ACCOUNTS * 1000, "no money created or lost");
+    check((total > 0) && (total < THREADS * TRANSFERS), "some transfers refused, others done");
+
+    std::cout << (failures ? "Sharded ledger test failed!" : "Sharded ledger test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
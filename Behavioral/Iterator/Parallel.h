@@ -0,0 +1,131 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <latch>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+/*
+ * Work over a random access range split into chunks of at least minChunk
+ * elements, run on a ThreadPool and the calling thread. Not from a task of the pool.
+ */
+namespace parallel
+{
+    constexpr size_t DEFAULT_CHUNK = 1 << 14;
+
+    template <std::ranges::random_access_range RANGE>
+    using Chunk = std::ranges::subrange<std::ranges::iterator_t<RANGE>>;
+
+    // At most parts chunks of at least minChunk elements, sizes differing by one at most
+    template <std::ranges::random_access_range RANGE>
+    std::vector<Chunk<RANGE>> split(RANGE&& range, size_t parts, size_t minChunk = 1)
+    {
+        std::vector<Chunk<RANGE>> chunks;
+        size_t size = std::ranges::size(range);
+        if (size == 0)
+            return chunks;
+
+        parts = std::clamp(size / std::max(minChunk, size_t{1}), size_t{1}, std::max(parts, size_t{1}));
+        chunks.reserve(parts);
+        auto first = std::ranges::begin(range);
+        for (size_t i = 0; i < parts; ++i)
+        {
+            auto length = static_cast<std::ranges::range_difference_t<RANGE>>(size / parts + (i < size % parts));
+            chunks.emplace_back(first, first + length);
+            first += length;
+        }
+        return chunks;
+    }
+
+    // Runs f(0) ... f(count - 1), the last one in the calling thread, rethrowing the first exception
+    template <typename F>
+    void runTasks(ThreadPool& pool, size_t count, F f)
+    {
+        if (count == 0)
+            return;
+
+        std::latch done(static_cast<std::ptrdiff_t>(count - 1));
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto run = [&](size_t i)
+        {
+            try
+            {
+                f(i);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+
+        for (size_t i = 0; i + 1 < count; ++i)
+            pool.post([&run, &done, i] { run(i); done.count_down(); });
+        run(count - 1);
+        done.wait();
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // Calls f(chunk) for the chunks of range, in parallel
+    template <std::ranges::random_access_range RANGE, typename F>
+    void forEachChunk(ThreadPool& pool, RANGE&& range, F f, size_t minChunk = DEFAULT_CHUNK)
+    {
+        auto chunks = split(range, pool.size() + 1, minChunk);
+        runTasks(pool, chunks.size(), [&](size_t i) { f(chunks[i]); });
+    }
+
+    // Folds init and the elements with op, which must be associative
+    template <std::ranges::random_access_range RANGE, typename T, typename OP = std::plus<>>
+    T reduce(ThreadPool& pool, RANGE&& range, T init, OP op = {}, size_t minChunk = DEFAULT_CHUNK)
+    {
+        auto chunks = split(range, pool.size() + 1, minChunk);
+        std::vector<T> results(chunks.size(), init);
+        runTasks(pool, chunks.size(), [&](size_t i)
+        {
+            auto first = chunks[i].begin();
+            results[i] = std::accumulate(std::next(first), chunks[i].end(), T(*first), op);
+        });
+        return std::accumulate(results.begin(), results.end(), std::move(init), op);
+    }
+
+    // Sorts the chunks in parallel, then merges them two by two
+    template <std::ranges::random_access_range RANGE, typename COMPARE = std::ranges::less>
+    void sort(ThreadPool& pool, RANGE&& range, COMPARE compare = {}, size_t minChunk = DEFAULT_CHUNK)
+    {
+        auto chunks = split(range, pool.size() + 1, minChunk);
+        runTasks(pool, chunks.size(), [&](size_t i) { std::sort(chunks[i].begin(), chunks[i].end(), compare); });
+
+        // bounds of the sorted runs
+        std::vector<std::ranges::iterator_t<RANGE>> bounds;
+        for (const auto& chunk : chunks)
+            bounds.push_back(chunk.begin());
+        if (!chunks.empty())
+            bounds.push_back(chunks.back().end());
+
+        while (bounds.size() > 2)
+        {
+            size_t runs = bounds.size() - 1;
+            runTasks(pool, runs / 2, [&](size_t i)
+            {
+                std::inplace_merge(bounds[2 * i], bounds[2 * i + 1], bounds[2 * i + 2], compare);
+            });
+
+            std::vector<std::ranges::iterator_t<RANGE>> merged;
+            for (size_t i = 0; i < runs; i += 2)
+                merged.push_back(bounds[i]);
+            merged.push_back(bounds.back());
+            bounds = std::move(merged);
+        }
+    }
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include "Vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Vector storing up to N elements inside the object itself, on the heap beyond.
+ * A moved-from vector is left empty and inline.
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+    static_assert(N > 0, "Use Vector for no inline capacity!");
+
+public:
+    using ValueType = T;
+    using Iterator = VectorIterator<SmallVector<T, N>>;
+    using ConstIterator = VectorIterator<const SmallVector<T, N>>;
+
+    SmallVector() = default;
+
+    SmallVector(std::initializer_list<T> initList)
+    {
+        reserve(initList.size());
+        for (const auto& item : initList)
+            emplaceBack(item);
+    }
+
+    SmallVector(const SmallVector& other)
+    {
+        reserve(other.m_size);
+        for (size_t i = 0; i < other.m_size; ++i)
+            emplaceBack(other.m_array[i]);
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        take(other);
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        release();
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other.m_size);
+            for (size_t i = 0; i < other.m_size; ++i)
+                emplaceBack(other.m_array[i]);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            clear();
+            if (!other.isInline())
+            {
+                release(); // the other storage is adopted instead
+                m_array = inlineArray();
+                m_capacity = N;
+            }
+            take(other);
+        }
+        return *this;
+    }
+
+    void pushBack(const T& x)
+    {
+        emplaceBack(x);
+    }
+
+    void pushBack(T&& x)
+    {
+        emplaceBack(std::move(x));
+    }
+
+    template <typename ... ARGS>
+    T& emplaceBack(ARGS&& ... args)
+    {
+        if (m_size < m_capacity)
+        {
+            std::construct_at(m_array + m_size, std::forward<ARGS>(args)...);
+            return m_array[m_size++];
+        }
+
+        // the new element is constructed first: args may refer to an element being moved
+        size_t newCapacity = m_capacity * 2;
+        T* newArray = std::allocator<T>().allocate(newCapacity);
+        try
+        {
+            std::construct_at(newArray + m_size, std::forward<ARGS>(args)...);
+        }
+        catch (...)
+        {
+            std::allocator<T>().deallocate(newArray, newCapacity);
+            throw;
+        }
+        relocate(newArray, newCapacity, 1);
+        return m_array[m_size++];
+    }
+
+    void popBack()
+    {
+        if (m_size > 0)
+        {
+            m_size--;
+            std::destroy_at(m_array + m_size);
+        }
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    // Whether the elements are stored in the object, not on the heap
+    bool isInline() const
+    {
+        return m_array == inlineArray();
+    }
+
+    T* data()
+    {
+        return m_array;
+    }
+
+    const T* data() const
+    {
+        return m_array;
+    }
+
+    const T& operator[](size_t index) const
+    {
+        return m_array[index];
+    }
+
+    T& operator[](size_t index)
+    {
+        return m_array[index];
+    }
+
+    void reserve(size_t newCapacity)
+    {
+        if (newCapacity > m_capacity)
+            relocate(std::allocator<T>().allocate(newCapacity), newCapacity, 0);
+    }
+
+    // Releases the unused capacity, going back inline if the elements fit
+    void shrinkToFit()
+    {
+        if (isInline() || m_capacity == m_size)
+            return;
+        if (m_size <= N)
+            relocate(inlineArray(), N, 0);
+        else
+            relocate(std::allocator<T>().allocate(m_size), m_size, 0);
+    }
+
+    void clear()
+    {
+        std::destroy_n(m_array, m_size);
+        m_size = 0;
+    }
+
+    Iterator begin()
+    {
+        return Iterator(m_array);
+    }
+
+    Iterator end()
+    {
+        return Iterator(m_array + m_size);
+    }
+
+    ConstIterator begin() const
+    {
+        return ConstIterator(m_array);
+    }
+
+    ConstIterator end() const
+    {
+        return ConstIterator(m_array + m_size);
+    }
+
+    ConstIterator cbegin() const
+    {
+        return begin();
+    }
+
+    ConstIterator cend() const
+    {
+        return end();
+    }
+
+private:
+    alignas(T) std::byte m_inline[N * sizeof(T)];
+    T* m_array {inlineArray()};
+    size_t m_size {0};
+    size_t m_capacity {N};
+
+    T* inlineArray()
+    {
+        return std::launder(reinterpret_cast<T*>(m_inline));
+    }
+
+    const T* inlineArray() const
+    {
+        return std::launder(reinterpret_cast<const T*>(m_inline));
+    }
+
+    // Frees the heap storage, if any; the elements must be destroyed already
+    void release()
+    {
+        if (!isInline())
+            std::allocator<T>().deallocate(m_array, m_capacity);
+    }
+
+    // Moves the content of other into this empty, inline, vector
+    void take(SmallVector& other)
+    {
+        if (!other.isInline())
+        {
+            m_array = std::exchange(other.m_array, other.inlineArray());
+            m_size = std::exchange(other.m_size, 0);
+            m_capacity = std::exchange(other.m_capacity, N);
+            return;
+        }
+
+        if constexpr (IsTriviallyRelocatable<T>::value)
+        {
+            if (other.m_size)
+                memcpy(static_cast<void*>(m_array), static_cast<const void*>(other.m_array), other.m_size * sizeof(T));
+            m_size = std::exchange(other.m_size, 0);
+        }
+        else
+        {
+            size_t i = 0;
+            try
+            {
+                for (; i < other.m_size; ++i)
+                    std::construct_at(m_array + i, std::move(other.m_array[i]));
+            }
+            catch (...)
+            {
+                std::destroy_n(m_array, i); // a throwing constructor gets no destructor call
+                throw;
+            }
+            m_size = i;
+            other.clear();
+        }
+    }
+
+    // Moves the elements in front of the constructed ones in newArray, and adopts it
+    void relocate(T* newArray, size_t newCapacity, size_t constructed)
+    {
+        if constexpr (IsTriviallyRelocatable<T>::value)
+        {
+            if (m_size)
+                memcpy(static_cast<void*>(newArray), static_cast<const void*>(m_array), m_size * sizeof(T));
+        }
+        else if constexpr (std::is_nothrow_move_constructible_v<T>)
+        {
+            for (size_t i = 0; i < m_size; ++i)
+            {
+                std::construct_at(newArray + i, std::move(m_array[i]));
+                std::destroy_at(m_array + i);
+            }
+        }
+        else
+        {
+            size_t i = 0;
+            try
+            {
+                for (; i < m_size; ++i)
+                    std::construct_at(newArray + i, std::move_if_noexcept(m_array[i]));
+            }
+            catch (...)
+            {
+                // the original elements, copied, are intact
+                std::destroy_n(newArray, i);
+                std::destroy_n(newArray + m_size, constructed);
+                if (newArray != inlineArray())
+                    std::allocator<T>().deallocate(newArray, newCapacity);
+                throw;
+            }
+            std::destroy_n(m_array, m_size);
+        }
+
+        release();
+        m_array = newArray;
+        m_capacity = newCapacity;
+    }
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+struct SomeData
+{
+    std::string m_string;
+    unsigned long m_number;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running posted tasks in FIFO order
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency())
+    {
+        for (unsigned i = 0; i < std::max(threadCount, 1u); ++i)
+            workers.emplace_back([this] { run(); });
+    }
+
+    // Tasks already posted are run before the workers stop
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void post(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        wakeUp.notify_one();
+    }
+
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock lock(mutex);
+        while (true)
+        {
+            wakeUp.wait(lock, [this] { return !tasks.empty() || stopping; });
+            if (tasks.empty())
+                return; // stopping, and nothing left to do
+
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<std::function<void()>> tasks;
+    bool stopping {false};
+    std::vector<std::jthread> workers; // last: started once everything else is constructed
+};
@@ -1,22 +1,53 @@
 #pragma once
 
+#include <algorithm>
+#include <compare>
 #include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <new>
+#include <type_traits>
 #include <utility>
 
+/*
+ * Contiguous iterator over the elements of VECTOR, which has a ValueType.
+ * VectorIterator<const VECTOR> iterates over const elements; an iterator
+ * converts to it implicitly, so that both can be compared.
+ */
 template <typename VECTOR>
 class VectorIterator
 {
 public:
     using ValueType = typename VECTOR::ValueType;
-    using PointerType = ValueType*;
-    using ReferenceType = ValueType&;
+    using ElementType = std::conditional_t<std::is_const_v<VECTOR>, const ValueType, ValueType>;
+    using PointerType = ElementType*;
+    using ReferenceType = ElementType&;
+
+    // for the standard algorithms
+    using iterator_concept = std::contiguous_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = ValueType;
+    using element_type = ElementType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = PointerType;
+    using reference = ReferenceType;
 
 public:
+    VectorIterator() = default;
+
     explicit VectorIterator(PointerType ptr)
     : m_ptr(ptr)
     {}
 
+    template <typename OTHER>
+        requires (std::is_const_v<VECTOR> && std::is_same_v<OTHER, std::remove_const_t<VECTOR>>)
+    VectorIterator(const VectorIterator<OTHER>& other)
+    : m_ptr(other.m_ptr)
+    {}
+
     VectorIterator& operator++() // pre-increment
     {
         ++m_ptr;
@@ -43,92 +74,186 @@ public:
         return copy;
     }
 
-    ReferenceType operator[](size_t index)
+    VectorIterator& operator+=(difference_type n)
     {
-        return *(m_ptr+index);
+        m_ptr += n;
+        return *this;
     }
 
-    PointerType operator->()
+    VectorIterator& operator-=(difference_type n)
     {
-        return m_ptr;
+        m_ptr -= n;
+        return *this;
     }
 
-    ReferenceType operator*()
+    friend VectorIterator operator+(VectorIterator it, difference_type n)
     {
-        return *m_ptr;
+        return it += n;
+    }
+
+    friend VectorIterator operator+(difference_type n, VectorIterator it)
+    {
+        return it += n;
     }
 
-    bool operator==(const VectorIterator& other) const
+    friend VectorIterator operator-(VectorIterator it, difference_type n)
     {
-        return (m_ptr == other.m_ptr);
+        return it -= n;
     }
 
-    bool operator!=(const VectorIterator& other) const
+    friend difference_type operator-(const VectorIterator& a, const VectorIterator& b)
     {
-        return (m_ptr != other.m_ptr);
+        return a.m_ptr - b.m_ptr;
     }
 
+    ReferenceType operator[](difference_type index) const
+    {
+        return *(m_ptr+index);
+    }
+
+    PointerType operator->() const
+    {
+        return m_ptr;
+    }
+
+    ReferenceType operator*() const
+    {
+        return *m_ptr;
+    }
+
+    bool operator==(const VectorIterator& other) const = default;
+    auto operator<=>(const VectorIterator& other) const = default;
+
 private:
-    PointerType m_ptr;
+    template <typename>
+    friend class VectorIterator;
+
+    PointerType m_ptr {nullptr};
 };
 
+// Types whose objects can be moved with memcpy, leaving nothing to destroy: specialize it to opt in
 template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T>
+{};
+
+/*
+ * Contiguous dynamic array of elements constructed in storage from ALLOCATOR.
+ * Trivially relocatable elements are moved with memcpy when growing.
+ */
+template <typename T, typename ALLOCATOR = std::allocator<T>>
 class Vector
 {
+    using Traits = std::allocator_traits<ALLOCATOR>;
+
 public:
     using ValueType = T;
-    using Iterator = VectorIterator<Vector<T>>;
+    using AllocatorType = ALLOCATOR;
+    using Iterator = VectorIterator<Vector<T, ALLOCATOR>>;
+    using ConstIterator = VectorIterator<const Vector<T, ALLOCATOR>>;
+
+    Vector() = default; // no allocation until the first element
 
-    Vector()
+    explicit Vector(const ALLOCATOR& allocator)
+    : m_allocator(allocator)
+    {}
+
+    Vector(std::initializer_list<T> initList, const ALLOCATOR& allocator = ALLOCATOR())
+    : m_allocator(allocator)
+    {
+        reserve(initList.size());
+        for (const auto& item : initList)
+            emplaceBack(item);
+    }
+
+    Vector(const Vector& other)
+    : m_allocator(Traits::select_on_container_copy_construction(other.m_allocator))
     {
-        allocate(2);
+        reserve(other.m_size);
+        for (size_t i = 0; i < other.m_size; ++i)
+            emplaceBack(other.m_array[i]);
     }
 
+    Vector(Vector&& other) noexcept
+    : m_allocator(other.m_allocator)
+    , m_array(std::exchange(other.m_array, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_capacity(std::exchange(other.m_capacity, 0))
+    {}
+
     ~Vector()
     {
         clear();
-        ::operator delete(m_array, sizeof(T) * m_capacity);
+        deallocate(m_array, m_capacity);
     }
 
-    Vector(std::initializer_list<T> initList)
+    Vector& operator=(const Vector& other)
     {
-        allocate(initList.size());
-        for (const auto& item : initList)
-            m_array[m_size++] = item;
+        if (this != &other)
+        {
+            clear();
+            reserve(other.m_size);
+            for (size_t i = 0; i < other.m_size; ++i)
+                emplaceBack(other.m_array[i]);
+        }
+        return *this;
     }
 
-    Vector(const Vector& other)
-    : m_size(other.m_size)
-    , m_capacity(other.m_size)
+    Vector& operator=(Vector&& other) noexcept(Traits::is_always_equal::value)
     {
-        allocate(m_capacity);
-        for (size_t i = 0; i < m_size; ++i)
-            m_array[i] = other.m_array[i];
+        if (this == &other)
+            return *this;
+
+        clear();
+        if (m_allocator == other.m_allocator)
+        {
+            // same memory resource: the storage can change hands
+            deallocate(m_array, m_capacity);
+            m_array = std::exchange(other.m_array, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_capacity = std::exchange(other.m_capacity, 0);
+        }
+        else
+        {
+            reserve(other.m_size);
+            for (size_t i = 0; i < other.m_size; ++i)
+                emplaceBack(std::move(other.m_array[i]));
+            other.clear();
+        }
+        return *this;
     }
 
     void pushBack(const T& x)
     {
-        if (m_size == m_capacity)
-            allocate(m_capacity + m_capacity / 2);
-
-        m_array[m_size++] = x;
+        emplaceBack(x);
     }
 
     void pushBack(T&& x)
     {
-        if (m_size == m_capacity)
-            allocate(m_capacity + m_capacity / 2);
-
-        m_array[m_size++] = std::move(x);
+        emplaceBack(std::move(x));
     }
 
     template <typename ... ARGS>
     T& emplaceBack(ARGS&& ... args)
     {
-        if (m_size == m_capacity)
-            allocate(m_capacity + m_capacity / 2);
+        if (m_size < m_capacity)
+        {
+            Traits::construct(m_allocator, m_array + m_size, std::forward<ARGS>(args)...);
+            return m_array[m_size++];
+        }
 
-        new(&m_array[m_size]) T(std::forward<ARGS>(args)...);
+        // the new element is constructed first: args may refer to an element being moved
+        size_t newCapacity = std::max(m_capacity * 2, size_t{4});
+        T* newArray = allocate(newCapacity);
+        try
+        {
+            Traits::construct(m_allocator, newArray + m_size, std::forward<ARGS>(args)...);
+        }
+        catch (...)
+        {
+            deallocate(newArray, newCapacity);
+            throw;
+        }
+        relocate(newArray, newCapacity, 1);
         return m_array[m_size++];
     }
 
@@ -137,7 +262,7 @@ public:
         if (m_size > 0)
         {
             m_size--;
-            m_array[m_size].~T();
+            Traits::destroy(m_allocator, m_array + m_size);
         }
     }
 
@@ -146,6 +271,31 @@ public:
         return m_size;
     }
 
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    T* data()
+    {
+        return m_array;
+    }
+
+    const T* data() const
+    {
+        return m_array;
+    }
+
+    ALLOCATOR getAllocator() const
+    {
+        return m_allocator;
+    }
+
     const T& operator[](size_t index) const
     {
         return m_array[index];
@@ -156,10 +306,33 @@ public:
         return m_array[index];
     }
 
+    // Makes room for newCapacity elements, so that adding them does not reallocate
+    void reserve(size_t newCapacity)
+    {
+        if (newCapacity > m_capacity)
+            relocate(allocate(newCapacity), newCapacity, 0);
+    }
+
+    // Releases the unused capacity
+    void shrinkToFit()
+    {
+        if (m_capacity == m_size)
+            return;
+        if (m_size == 0)
+        {
+            deallocate(m_array, m_capacity);
+            m_array = nullptr;
+            m_capacity = 0;
+            return;
+        }
+        relocate(allocate(m_size), m_size, 0);
+    }
+
     void clear()
     {
-        for (size_t i = 0; i < m_size; ++i)
-            m_array[i].~T();
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (size_t i = 0; i < m_size; ++i)
+                Traits::destroy(m_allocator, m_array + i);
         m_size = 0;
     }
 
@@ -173,29 +346,91 @@ public:
         return Iterator(m_array + m_size);
     }
 
+    ConstIterator begin() const
+    {
+        return ConstIterator(m_array);
+    }
+
+    ConstIterator end() const
+    {
+        return ConstIterator(m_array + m_size);
+    }
+
+    ConstIterator cbegin() const
+    {
+        return begin();
+    }
+
+    ConstIterator cend() const
+    {
+        return end();
+    }
+
 private:
+    [[no_unique_address]] ALLOCATOR m_allocator;
     T* m_array {nullptr};
     size_t m_size {0};
     size_t m_capacity {0};
 
-    void allocate(size_t newCapacity)
+    T* allocate(size_t capacity)
     {
-        T* newArray = (T*) ::operator new(sizeof(T) * newCapacity);
-
-        size_t old_size = m_size;
-        if (newCapacity < m_size)
-            m_size = newCapacity;
-
-        for (size_t i = 0; i < m_size; ++i)
-            newArray[i] = std::move(m_array[i]);
+        return Traits::allocate(m_allocator, capacity);
+    }
 
-        for (size_t i = 0; i < old_size; ++i)
-            m_array[i].~T();
+    void deallocate(T* array, size_t capacity)
+    {
+        if (array)
+            Traits::deallocate(m_allocator, array, capacity);
+    }
 
-        ::operator delete(m_array, sizeof(T) * m_capacity);
+    // Moves the elements in front of the constructed ones in newArray, and adopts it
+    void relocate(T* newArray, size_t newCapacity, size_t constructed)
+    {
+        if constexpr (IsTriviallyRelocatable<T>::value)
+        {
+            if (m_size)
+                memcpy(static_cast<void*>(newArray), static_cast<const void*>(m_array), m_size * sizeof(T));
+        }
+        else if constexpr (std::is_nothrow_move_constructible_v<T>)
+        {
+            // one pass: the source elements are still in cache when destroyed
+            for (size_t i = 0; i < m_size; ++i)
+            {
+                Traits::construct(m_allocator, newArray + i, std::move(m_array[i]));
+                Traits::destroy(m_allocator, m_array + i);
+            }
+        }
+        else
+        {
+            size_t i = 0;
+            try
+            {
+                for (; i < m_size; ++i)
+                    Traits::construct(m_allocator, newArray + i, std::move_if_noexcept(m_array[i]));
+            }
+            catch (...)
+            {
+                // the original elements, copied, are intact
+                for (size_t j = 0; j < i; ++j)
+                    Traits::destroy(m_allocator, newArray + j);
+                for (size_t j = 0; j < constructed; ++j)
+                    Traits::destroy(m_allocator, newArray + m_size + j);
+                deallocate(newArray, newCapacity);
+                throw;
+            }
+            for (size_t j = 0; j < m_size; ++j)
+                Traits::destroy(m_allocator, m_array + j);
+        }
 
+        deallocate(m_array, m_capacity);
         m_array = newArray;
         m_capacity = newCapacity;
     }
-
 };
+
+namespace pmr
+{
+    // Vector taking its memory from a std::pmr::memory_resource
+    template <typename T>
+    using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>>;
+}
@@ -0,0 +1,564 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Vectorized algorithms over int32_t and float Vectors, or anything with data()
+ * and size(), calling the best of the scalar, SSE4 and AVX2 kernels for the CPU.
+ */
+namespace simd
+{
+    enum class ISA
+    {
+        SCALAR,
+        SSE4,
+        AVX2
+    };
+
+    template <typename T>
+    concept Element = std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+    // Integers are summed in 64 bits, floats in float
+    template <Element T>
+    using SumType = std::conditional_t<std::is_integral_v<T>, int64_t, float>;
+
+    inline ISA detectIsa()
+    {
+#ifdef SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return ISA::AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return ISA::SSE4;
+#endif
+        return ISA::SCALAR;
+    }
+
+    // Best instruction set of this CPU
+    inline ISA isa()
+    {
+        static const ISA detected = detectIsa();
+        return detected;
+    }
+
+    // Fills larger than this bypass the caches
+    inline size_t streamingThreshold()
+    {
+        static const size_t threshold = []
+        {
+#ifdef _SC_LEVEL3_CACHE_SIZE
+            long cache = sysconf(_SC_LEVEL3_CACHE_SIZE);
+            if (cache > 0)
+                return static_cast<size_t>(cache) / 4 * 3;
+#endif
+            return size_t{8} << 20;
+        }();
+        return threshold;
+    }
+
+    // The kernels of min and max need at least one element
+    namespace scalar
+    {
+        template <Element T>
+        SumType<T> sum(const T* data, size_t size)
+        {
+            SumType<T> total = 0;
+            for (size_t i = 0; i < size; ++i)
+                total += data[i];
+            return total;
+        }
+
+        template <Element T>
+        T min(const T* data, size_t size)
+        {
+            T result = data[0];
+            for (size_t i = 1; i < size; ++i)
+                result = data[i] < result ? data[i] : result;
+            return result;
+        }
+
+        template <Element T>
+        T max(const T* data, size_t size)
+        {
+            T result = data[0];
+            for (size_t i = 1; i < size; ++i)
+                result = data[i] > result ? data[i] : result;
+            return result;
+        }
+
+        // Returns size if there is no such value
+        template <Element T>
+        size_t find(const T* data, size_t size, T value)
+        {
+            for (size_t i = 0; i < size; ++i)
+                if (data[i] == value)
+                    return i;
+            return size;
+        }
+
+        template <Element T>
+        size_t count(const T* data, size_t size, T value)
+        {
+            size_t result = 0;
+            for (size_t i = 0; i < size; ++i)
+                result += data[i] == value;
+            return result;
+        }
+
+        template <typename T, typename U, typename F>
+        void transform(const T* in, size_t size, U* out, F f)
+        {
+            for (size_t i = 0; i < size; ++i)
+                out[i] = f(in[i]);
+        }
+
+        template <Element T>
+        void fill(T* data, size_t size, T value)
+        {
+            std::fill(data, data + size, value);
+        }
+
+        template <Element T>
+        void copy(const T* in, size_t size, T* out)
+        {
+            if (size)
+                memmove(out, in, size * sizeof(T));
+        }
+    }
+
+#ifdef SIMD_X86
+    namespace sse4
+    {
+#define SIMD_TARGET __attribute__((target("sse4.1")))
+
+        SIMD_TARGET inline __m128i load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        SIMD_TARGET inline __m128 load(const float* p) { return _mm_loadu_ps(p); }
+        SIMD_TARGET inline void store(int32_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        SIMD_TARGET inline void store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+
+        struct Min
+        {
+            SIMD_TARGET __m128i operator()(__m128i a, __m128i b) const { return _mm_min_epi32(a, b); }
+            SIMD_TARGET __m128 operator()(__m128 a, __m128 b) const { return _mm_min_ps(a, b); }
+        };
+
+        struct Max
+        {
+            SIMD_TARGET __m128i operator()(__m128i a, __m128i b) const { return _mm_max_epi32(a, b); }
+            SIMD_TARGET __m128 operator()(__m128 a, __m128 b) const { return _mm_max_ps(a, b); }
+        };
+
+        // All lanes of 4 elements from p equal to value
+        template <Element T>
+        SIMD_TARGET __m128i equal(const T* p, T value)
+        {
+            if constexpr (std::is_integral_v<T>)
+                return _mm_cmpeq_epi32(load(p), _mm_set1_epi32(value));
+            else
+                return _mm_castps_si128(_mm_cmpeq_ps(load(p), _mm_set1_ps(value)));
+        }
+
+        template <Element T>
+        SIMD_TARGET SumType<T> sum(const T* data, size_t size)
+        {
+            size_t i = 0;
+            if constexpr (std::is_integral_v<T>)
+            {
+                __m128i s0 = _mm_setzero_si128(), s1 = s0;
+                for (; i + 4 <= size; i += 4)
+                {
+                    __m128i v = load(data + i);
+                    s0 = _mm_add_epi64(s0, _mm_cvtepi32_epi64(v));
+                    s1 = _mm_add_epi64(s1, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+                }
+                alignas(16) int64_t lanes[2];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(s0, s1));
+                return lanes[0] + lanes[1] + scalar::sum(data + i, size - i);
+            }
+            else
+            {
+                __m128 s0 = _mm_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+                for (; i + 16 <= size; i += 16)
+                {
+                    s0 = _mm_add_ps(s0, load(data + i));
+                    s1 = _mm_add_ps(s1, load(data + i + 4));
+                    s2 = _mm_add_ps(s2, load(data + i + 8));
+                    s3 = _mm_add_ps(s3, load(data + i + 12));
+                }
+                for (; i + 4 <= size; i += 4)
+                    s0 = _mm_add_ps(s0, load(data + i));
+                float lanes[4];
+                store(lanes, _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+                return scalar::sum(lanes, 4) + scalar::sum(data + i, size - i);
+            }
+        }
+
+        // Combines at least 4 elements with OP into 4 lanes
+        template <Element T, typename OP>
+        SIMD_TARGET void reduce(const T* data, size_t size, OP op, T* lanes)
+        {
+            auto r0 = load(data), r1 = r0, r2 = r0, r3 = r0;
+            size_t i = 4;
+            for (; i + 16 <= size; i += 16)
+            {
+                r0 = op(r0, load(data + i));
+                r1 = op(r1, load(data + i + 4));
+                r2 = op(r2, load(data + i + 8));
+                r3 = op(r3, load(data + i + 12));
+            }
+            for (; i + 4 <= size; i += 4)
+                r0 = op(r0, load(data + i));
+            r0 = op(r0, load(data + size - 4)); // overlapping tail
+            store(lanes, op(op(r0, r1), op(r2, r3)));
+        }
+
+        template <Element T>
+        SIMD_TARGET T min(const T* data, size_t size)
+        {
+            if (size < 4)
+                return scalar::min(data, size);
+            T lanes[4];
+            reduce(data, size, Min(), lanes);
+            return scalar::min(lanes, 4);
+        }
+
+        template <Element T>
+        SIMD_TARGET T max(const T* data, size_t size)
+        {
+            if (size < 4)
+                return scalar::max(data, size);
+            T lanes[4];
+            reduce(data, size, Max(), lanes);
+            return scalar::max(lanes, 4);
+        }
+
+        template <Element T>
+        SIMD_TARGET size_t find(const T* data, size_t size, T value)
+        {
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i e = _mm_or_si128(_mm_or_si128(equal(data + i, value), equal(data + i + 4, value)),
+                                         _mm_or_si128(equal(data + i + 8, value), equal(data + i + 12, value)));
+                if (!_mm_testz_si128(e, e))
+                    return i + scalar::find(data + i, 16, value);
+            }
+            return i + scalar::find(data + i, size - i, value);
+        }
+
+        template <Element T>
+        SIMD_TARGET size_t count(const T* data, size_t size, T value)
+        {
+            // a match is -1 in its lane: subtracting it counts, flushed long before a lane overflows
+            size_t result = 0;
+            size_t i = 0;
+            while (i + 4 <= size)
+            {
+                __m128i c = _mm_setzero_si128();
+                size_t end = i + std::min(size - i, size_t{4} << 20) / 4 * 4;
+                for (; i < end; i += 4)
+                    c = _mm_sub_epi32(c, equal(data + i, value));
+                int32_t lanes[4];
+                store(lanes, c);
+                result += scalar::sum(lanes, 4);
+            }
+            return result + scalar::count(data + i, size - i, value);
+        }
+
+        // Compiled for SSE4: the compiler vectorizes the loop with f inlined
+        template <typename T, typename U, typename F>
+        SIMD_TARGET void transform(const T* in, size_t size, U* out, F f)
+        {
+            for (size_t i = 0; i < size; ++i)
+                out[i] = f(in[i]);
+        }
+
+        template <Element T>
+        SIMD_TARGET void fill(T* data, size_t size, T value)
+        {
+            __m128i v;
+            if constexpr (std::is_integral_v<T>)
+                v = _mm_set1_epi32(value);
+            else
+                v = _mm_castps_si128(_mm_set1_ps(value));
+            size_t i = 0;
+            if (size * sizeof(T) > streamingThreshold())
+            {
+                for (; reinterpret_cast<uintptr_t>(data + i) % 16; ++i)
+                    data[i] = value;
+                for (; i + 4 <= size; i += 4)
+                    _mm_stream_si128(reinterpret_cast<__m128i*>(data + i), v);
+                _mm_sfence();
+            }
+            for (; i + 4 <= size; i += 4)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), v);
+            for (; i < size; ++i)
+                data[i] = value;
+        }
+
+#undef SIMD_TARGET
+    }
+
+    namespace avx2
+    {
+#define SIMD_TARGET __attribute__((target("avx2")))
+
+        SIMD_TARGET inline __m256i load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        SIMD_TARGET inline __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+        SIMD_TARGET inline void store(int32_t* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        SIMD_TARGET inline void store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+
+        struct Min
+        {
+            SIMD_TARGET __m256i operator()(__m256i a, __m256i b) const { return _mm256_min_epi32(a, b); }
+            SIMD_TARGET __m256 operator()(__m256 a, __m256 b) const { return _mm256_min_ps(a, b); }
+        };
+
+        struct Max
+        {
+            SIMD_TARGET __m256i operator()(__m256i a, __m256i b) const { return _mm256_max_epi32(a, b); }
+            SIMD_TARGET __m256 operator()(__m256 a, __m256 b) const { return _mm256_max_ps(a, b); }
+        };
+
+        // All lanes of 8 elements from p equal to value
+        template <Element T>
+        SIMD_TARGET __m256i equal(const T* p, T value)
+        {
+            if constexpr (std::is_integral_v<T>)
+                return _mm256_cmpeq_epi32(load(p), _mm256_set1_epi32(value));
+            else
+                return _mm256_castps_si256(_mm256_cmp_ps(load(p), _mm256_set1_ps(value), _CMP_EQ_OQ));
+        }
+
+        template <Element T>
+        SIMD_TARGET SumType<T> sum(const T* data, size_t size)
+        {
+            size_t i = 0;
+            if constexpr (std::is_integral_v<T>)
+            {
+                __m256i s0 = _mm256_setzero_si256(), s1 = s0;
+                for (; i + 8 <= size; i += 8)
+                {
+                    __m256i v = load(data + i);
+                    s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+                    s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+                }
+                alignas(32) int64_t lanes[4];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(s0, s1));
+                return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar::sum(data + i, size - i);
+            }
+            else
+            {
+                __m256 s0 = _mm256_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+                for (; i + 32 <= size; i += 32)
+                {
+                    s0 = _mm256_add_ps(s0, load(data + i));
+                    s1 = _mm256_add_ps(s1, load(data + i + 8));
+                    s2 = _mm256_add_ps(s2, load(data + i + 16));
+                    s3 = _mm256_add_ps(s3, load(data + i + 24));
+                }
+                for (; i + 8 <= size; i += 8)
+                    s0 = _mm256_add_ps(s0, load(data + i));
+                float lanes[8];
+                store(lanes, _mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+                return scalar::sum(lanes, 8) + scalar::sum(data + i, size - i);
+            }
+        }
+
+        // Combines at least 8 elements with OP into 8 lanes
+        template <Element T, typename OP>
+        SIMD_TARGET void reduce(const T* data, size_t size, OP op, T* lanes)
+        {
+            auto r0 = load(data), r1 = r0, r2 = r0, r3 = r0;
+            size_t i = 8;
+            for (; i + 32 <= size; i += 32)
+            {
+                r0 = op(r0, load(data + i));
+                r1 = op(r1, load(data + i + 8));
+                r2 = op(r2, load(data + i + 16));
+                r3 = op(r3, load(data + i + 24));
+            }
+            for (; i + 8 <= size; i += 8)
+                r0 = op(r0, load(data + i));
+            r0 = op(r0, load(data + size - 8)); // overlapping tail
+            store(lanes, op(op(r0, r1), op(r2, r3)));
+        }
+
+        template <Element T>
+        SIMD_TARGET T min(const T* data, size_t size)
+        {
+            if (size < 8)
+                return scalar::min(data, size);
+            T lanes[8];
+            reduce(data, size, Min(), lanes);
+            return scalar::min(lanes, 8);
+        }
+
+        template <Element T>
+        SIMD_TARGET T max(const T* data, size_t size)
+        {
+            if (size < 8)
+                return scalar::max(data, size);
+            T lanes[8];
+            reduce(data, size, Max(), lanes);
+            return scalar::max(lanes, 8);
+        }
+
+        template <Element T>
+        SIMD_TARGET size_t find(const T* data, size_t size, T value)
+        {
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                __m256i e = _mm256_or_si256(_mm256_or_si256(equal(data + i, value), equal(data + i + 8, value)),
+                                            _mm256_or_si256(equal(data + i + 16, value), equal(data + i + 24, value)));
+                if (!_mm256_testz_si256(e, e))
+                    return i + scalar::find(data + i, 32, value);
+            }
+            return i + scalar::find(data + i, size - i, value);
+        }
+
+        template <Element T>
+        SIMD_TARGET size_t count(const T* data, size_t size, T value)
+        {
+            // a match is -1 in its lane: subtracting it counts, flushed long before a lane overflows
+            size_t result = 0;
+            size_t i = 0;
+            while (i + 8 <= size)
+            {
+                __m256i c = _mm256_setzero_si256();
+                size_t end = i + std::min(size - i, size_t{8} << 20) / 8 * 8;
+                for (; i < end; i += 8)
+                    c = _mm256_sub_epi32(c, equal(data + i, value));
+                int32_t lanes[8];
+                store(lanes, c);
+                result += scalar::sum(lanes, 8);
+            }
+            return result + scalar::count(data + i, size - i, value);
+        }
+
+        // Compiled for AVX2: the compiler vectorizes the loop with f inlined
+        template <typename T, typename U, typename F>
+        SIMD_TARGET void transform(const T* in, size_t size, U* out, F f)
+        {
+            for (size_t i = 0; i < size; ++i)
+                out[i] = f(in[i]);
+        }
+
+        template <Element T>
+        SIMD_TARGET void fill(T* data, size_t size, T value)
+        {
+            __m256i v;
+            if constexpr (std::is_integral_v<T>)
+                v = _mm256_set1_epi32(value);
+            else
+                v = _mm256_castps_si256(_mm256_set1_ps(value));
+            size_t i = 0;
+            if (size * sizeof(T) > streamingThreshold())
+            {
+                for (; reinterpret_cast<uintptr_t>(data + i) % 32; ++i)
+                    data[i] = value;
+                for (; i + 8 <= size; i += 8)
+                    _mm256_stream_si256(reinterpret_cast<__m256i*>(data + i), v);
+                _mm_sfence();
+            }
+            for (; i + 8 <= size; i += 8)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), v);
+            for (; i < size; ++i)
+                data[i] = value;
+        }
+
+#undef SIMD_TARGET
+    }
+#endif
+
+    // Calls the given kernel of the best instruction set of this CPU
+#ifdef SIMD_X86
+#define SIMD_DISPATCH(KERNEL, ...)                      \
+    switch (isa())                                      \
+    {                                                   \
+        case ISA::AVX2: return avx2::KERNEL(__VA_ARGS__); \
+        case ISA::SSE4: return sse4::KERNEL(__VA_ARGS__); \
+        default: return scalar::KERNEL(__VA_ARGS__);    \
+    }
+#else
+#define SIMD_DISPATCH(KERNEL, ...) return scalar::KERNEL(__VA_ARGS__);
+#endif
+
+    // Type of the elements of a vector, std::vector or span
+    template <typename VECTOR>
+    using ElementOf = std::remove_cvref_t<decltype(*std::declval<VECTOR&>().data())>;
+
+    template <typename VECTOR>
+    auto sum(const VECTOR& vector)
+    {
+        SIMD_DISPATCH(sum, vector.data(), vector.size())
+    }
+
+    template <typename VECTOR>
+    auto min(const VECTOR& vector)
+    {
+        if (vector.size() == 0)
+            throw std::runtime_error("No minimum in an empty vector!");
+        SIMD_DISPATCH(min, vector.data(), vector.size())
+    }
+
+    template <typename VECTOR>
+    auto max(const VECTOR& vector)
+    {
+        if (vector.size() == 0)
+            throw std::runtime_error("No maximum in an empty vector!");
+        SIMD_DISPATCH(max, vector.data(), vector.size())
+    }
+
+    // Index of the first element equal to value, size() if there is none
+    template <typename VECTOR>
+    size_t find(const VECTOR& vector, ElementOf<VECTOR> value)
+    {
+        SIMD_DISPATCH(find, vector.data(), vector.size(), value)
+    }
+
+    template <typename VECTOR>
+    size_t count(const VECTOR& vector, ElementOf<VECTOR> value)
+    {
+        SIMD_DISPATCH(count, vector.data(), vector.size(), value)
+    }
+
+    // out[i] = f(in[i]) for every element of in; out may be in itself
+    template <typename VECTOR, typename OUT, typename F>
+    void transform(const VECTOR& in, OUT& out, F f)
+    {
+        if (out.size() < in.size())
+            throw std::runtime_error("Output vector too small!");
+        SIMD_DISPATCH(transform, in.data(), in.size(), out.data(), f)
+    }
+
+    template <typename VECTOR>
+    void fill(VECTOR& vector, ElementOf<VECTOR> value)
+    {
+        SIMD_DISPATCH(fill, vector.data(), vector.size(), value)
+    }
+
+    // memmove already streams large copies with the best instructions of the CPU
+    template <typename VECTOR, typename OUT>
+    void copy(const VECTOR& in, OUT& out)
+    {
+        if (out.size() < in.size())
+            throw std::runtime_error("Output vector too small!");
+        scalar::copy(in.data(), in.size(), out.data());
+    }
+
+#undef SIMD_DISPATCH
+}
@@ -1,14 +1,9 @@
+#include "SomeData.h"
 #include "Vector.h"
 
 #include <iostream>
 #include <string>
 
-struct SomeData
-{
-    std::string m_string;
-    unsigned long m_number;
-};
-
 int main()
 {
     Vector<int> vInt;
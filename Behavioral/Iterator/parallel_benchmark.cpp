@@ -0,0 +1,81 @@
+// Sort and reduce of a Vector on one thread and spread over all the cores.
+// Build with -DCMAKE_BUILD_TYPE=Release to get meaningful numbers. The
+// element count can be given as argument, 100M by default.
+#include "Parallel.h"
+#include "ThreadPool.h"
+#include "Vector.h"
+#include "VectorAlgorithms.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#ifdef PARALLEL_STL
+#include <execution>
+#endif
+
+// Times the sum computed by f
+template <typename F>
+void benchmarkSum(const char* name, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    int64_t sum = f();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << ": " << elapsed.count() << " ms (" << sum << ")" << std::endl;
+}
+
+// Sorts a copy of data with sort, only the sort is timed
+template <typename SORT>
+void benchmarkSort(const char* name, const Vector<int32_t>& data, SORT sort)
+{
+    Vector<int32_t> copy = data;
+    auto start = std::chrono::steady_clock::now();
+    sort(copy);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << ": " << elapsed.count() << " ms"
+              << (std::is_sorted(copy.cbegin(), copy.cend()) ? "" : ", NOT SORTED") << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100'000'000;
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+    ThreadPool pool(threads - 1); // the calling thread takes a chunk too
+
+    Vector<int32_t> data;
+    data.reserve(count);
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < count; ++i)
+        data.pushBack(static_cast<int32_t>(rng()));
+    std::cout << count << " int32_t, " << pool.size() + 1 << " threads";
+#ifndef PARALLEL_STL
+    std::cout << ", no parallel standard library (TBB not found)";
+#endif
+    std::cout << std::endl;
+
+    std::cout << "Sum:" << std::endl;
+    benchmarkSum("std::accumulate", [&] { return std::accumulate(data.cbegin(), data.cend(), int64_t{0}); });
+#ifdef PARALLEL_STL
+    benchmarkSum("std::reduce(par)", [&] { return std::reduce(std::execution::par, data.cbegin(), data.cend(), int64_t{0}); });
+#endif
+    benchmarkSum("parallel::reduce", [&] { return parallel::reduce(pool, data, int64_t{0}); });
+    benchmarkSum("parallel::forEachChunk + simd::sum", [&]
+    {
+        std::atomic<int64_t> total {0};
+        parallel::forEachChunk(pool, data, [&](auto chunk) { total += simd::sum(chunk); });
+        return total.load();
+    });
+
+    std::cout << "Sort:" << std::endl;
+    benchmarkSort("std::sort", data, [](auto& v) { std::sort(v.begin(), v.end()); });
+    benchmarkSort("std::ranges::sort", data, [](auto& v) { std::ranges::sort(v); });
+#ifdef PARALLEL_STL
+    benchmarkSort("std::sort(par)", data, [](auto& v) { std::sort(std::execution::par, v.begin(), v.end()); });
+#endif
+    benchmarkSort("parallel::sort", data, [&](auto& v) { parallel::sort(pool, v); });
+}
@@ -0,0 +1,104 @@
+// Checks the parallel algorithms on ranges of every size relative to the chunks
+#include "Parallel.h"
+#include "Vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    std::vector<int> none;
+    check(parallel::split(none, 4).empty(), "no chunk for an empty range");
+    std::vector<int> ten(10);
+    check(parallel::split(ten, 4, 100).size() == 1, "one chunk for a range smaller than a chunk");
+    check(parallel::split(ten, 0).size() == 1, "one chunk at least");
+    auto chunks = parallel::split(ten, 4);
+    bool balanced = (chunks.size() == 4) && (chunks.front().begin() == ten.begin()) && (chunks.back().end() == ten.end());
+    for (size_t i = 0; balanced && (i < chunks.size()); ++i)
+        balanced = (chunks[i].size() == ((i < 2) ? 3u : 2u)) && ((i == 0) || (chunks[i - 1].end() == chunks[i].begin()));
+    check(balanced, "chunks contiguous, sizes differing by one");
+
+    ThreadPool pool(3);
+    std::mt19937 random(1);
+    bool sorted = true;
+    bool reduced = true;
+    bool visited = true;
+    // from empty to more elements than the pool has chunks, with chunks of 4 elements at least
+    for (size_t size : {0, 1, 3, 4, 5, 7, 9, 15, 16, 17, 100, 1001})
+    {
+        Vector<int> numbers;
+        for (size_t i = 0; i < size; ++i)
+            numbers.pushBack(static_cast<int>(random() % 50)); // duplicates too
+        std::vector<int> expected(numbers.begin(), numbers.end());
+        std::sort(expected.begin(), expected.end());
+
+        long long total = 0;
+        for (int n : expected)
+            total += n;
+        reduced = reduced && (parallel::reduce(pool, numbers, 0LL, std::plus<>(), 4) == total);
+
+        std::vector<int> counts(size);
+        std::vector<int> indices(size);
+        for (size_t i = 0; i < size; ++i)
+            indices[i] = static_cast<int>(i);
+        parallel::forEachChunk(pool, indices, [&counts](auto chunk)
+        {
+            for (int i : chunk)
+                counts[i]++;
+        }, 4);
+        visited = visited && (std::count(counts.begin(), counts.end(), 1) == static_cast<long>(size));
+
+        parallel::sort(pool, numbers, std::ranges::less(), 4);
+        sorted = sorted && std::equal(numbers.begin(), numbers.end(), expected.begin(), expected.end());
+    }
+    check(reduced, "reduce");
+    check(visited, "every element visited once");
+    check(sorted, "sort");
+
+    // associative, not commutative: the chunks are combined in order
+    std::vector<std::string> letters;
+    for (char c = 'a'; c <= 'z'; ++c)
+        letters.emplace_back(1, c);
+    check(parallel::reduce(pool, letters, std::string(">"), std::plus<>(), 3) == ">abcdefghijklmnopqrstuvwxyz", "reduce in order");
+    check(parallel::reduce(pool, none, 42) == 42, "reduce of an empty range");
+
+    std::vector<int> descending(1000);
+    for (size_t i = 0; i < descending.size(); ++i)
+        descending[i] = static_cast<int>(i);
+    parallel::sort(pool, descending, std::greater<>(), 10);
+    check(std::is_sorted(descending.begin(), descending.end(), std::greater<>()), "sort with a comparison");
+
+    bool thrown = false;
+    try
+    {
+        parallel::forEachChunk(pool, descending, [](auto chunk)
+        {
+            if (chunk.back() < 100)
+                throw std::runtime_error("chunk failed");
+        }, 10);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "exception of a chunk rethrown");
+
+    std::cout << (failures ? "Parallel test failed!" : "Parallel test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+// The vectorized algorithms against a loop through VectorIterator, from data
+// fitting in L1 to data in DRAM. Build with -DCMAKE_BUILD_TYPE=Release to get
+// meaningful numbers.
+#include "Vector.h"
+#include "VectorAlgorithms.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+// Results are accumulated here, so that no computation is optimized away
+volatile double sink = 0;
+
+// Each measurement processes as many elements, whatever the size
+constexpr size_t WORK = size_t{256} << 20;
+
+// Returns the billions of elements processed per second
+template <typename RUN>
+double measure(size_t size, RUN run)
+{
+    size_t repeats = std::max(WORK / size, size_t{1});
+    run(); // warm up: caches, page faults
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i)
+        run();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(repeats * size) / elapsed.count();
+}
+
+template <typename LOOP, typename SCALAR, typename SSE4, typename AVX2>
+void row(const char* name, size_t size, LOOP loop, SCALAR scalar, SSE4 sse4, AVX2 avx2)
+{
+    std::cout << "    " << std::left << std::setw(16) << name << std::right
+              << std::setw(10) << measure(size, loop) << std::setw(10) << measure(size, scalar);
+    if (simd::isa() >= simd::ISA::SSE4)
+        std::cout << std::setw(10) << measure(size, sse4);
+    if (simd::isa() >= simd::ISA::AVX2)
+        std::cout << std::setw(10) << measure(size, avx2);
+    std::cout << std::endl;
+}
+
+void benchmark(const char* level, size_t size)
+{
+    Vector<int32_t> ints;
+    Vector<float> floats;
+    Vector<float> out;
+    ints.reserve(size);
+    floats.reserve(size);
+    out.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        ints.pushBack(static_cast<int32_t>(i % 1000));
+        floats.pushBack(static_cast<float>(i % 1000) / 8);
+        out.pushBack(0);
+    }
+    const int32_t* in = ints.data();
+    const float* fin = floats.data();
+    float* fout = out.data();
+
+    std::cout << "  " << size << " elements (" << level << "), billions of elements/s:" << std::endl;
+    std::cout << "    " << std::setw(16) << "" << std::setw(10) << "iterator" << std::setw(10) << "scalar"
+              << std::setw(10) << "SSE4" << std::setw(10) << "AVX2" << std::endl;
+
+#ifdef SIMD_X86
+    row("sum int", size,
+        [&] { int64_t t = 0; for (auto x : ints) t += x; sink = sink + t; },
+        [&] { sink = sink + simd::scalar::sum(in, size); },
+        [&] { sink = sink + simd::sse4::sum(in, size); },
+        [&] { sink = sink + simd::avx2::sum(in, size); });
+    row("sum float", size,
+        [&] { float t = 0; for (auto x : floats) t += x; sink = sink + t; },
+        [&] { sink = sink + simd::scalar::sum(fin, size); },
+        [&] { sink = sink + simd::sse4::sum(fin, size); },
+        [&] { sink = sink + simd::avx2::sum(fin, size); });
+    row("min float", size,
+        [&] { float m = floats[0]; for (auto x : floats) m = x < m ? x : m; sink = sink + m; },
+        [&] { sink = sink + simd::scalar::min(fin, size); },
+        [&] { sink = sink + simd::sse4::min(fin, size); },
+        [&] { sink = sink + simd::avx2::min(fin, size); });
+    row("find int", size, // absent: the whole vector is searched
+        [&] { size_t i = 0; for (auto it = ints.begin(); it != ints.end() && *it != -1; ++it) ++i; sink = sink + i; },
+        [&] { sink = sink + simd::scalar::find(in, size, -1); },
+        [&] { sink = sink + simd::sse4::find(in, size, -1); },
+        [&] { sink = sink + simd::avx2::find(in, size, -1); });
+    row("count int", size,
+        [&] { size_t c = 0; for (auto x : ints) c += x == 7; sink = sink + c; },
+        [&] { sink = sink + simd::scalar::count(in, size, 7); },
+        [&] { sink = sink + simd::sse4::count(in, size, 7); },
+        [&] { sink = sink + simd::avx2::count(in, size, 7); });
+    auto scale = [](float x) { return x * 1.5f + 2.0f; };
+    row("transform float", size,
+        [&] { auto o = out.begin(); for (auto x : floats) *o++ = scale(x); },
+        [&] { simd::scalar::transform(fin, size, fout, scale); },
+        [&] { simd::sse4::transform(fin, size, fout, scale); },
+        [&] { simd::avx2::transform(fin, size, fout, scale); });
+    row("fill float", size,
+        [&] { for (auto& x : out) x = 3.0f; },
+        [&] { simd::scalar::fill(fout, size, 3.0f); },
+        [&] { simd::sse4::fill(fout, size, 3.0f); },
+        [&] { simd::avx2::fill(fout, size, 3.0f); });
+#endif
+    std::cout << "    " << std::left << std::setw(16) << "copy float" << std::right
+              << std::setw(10) << measure(size, [&] { auto o = out.begin(); for (auto x : floats) *o++ = x; })
+              << std::setw(10) << measure(size, [&] { simd::copy(floats, out); }) << " (memmove)" << std::endl;
+}
+
+int main()
+{
+    const char* names[] = {"scalar", "SSE4", "AVX2"};
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Detected: " << names[static_cast<int>(simd::isa())] << ", fills over "
+              << (simd::streamingThreshold() >> 20) << " MiB bypass the caches" << std::endl;
+    benchmark("16 KiB, L1", size_t{4} << 10);
+    benchmark("512 KiB, L2", size_t{128} << 10);
+    benchmark("16 MiB, L3", size_t{4} << 20);
+    benchmark("512 MiB, DRAM", size_t{128} << 20);
+}
@@ -0,0 +1,148 @@
+// Checks that the scalar, SSE4 and AVX2 kernels agree, whatever the size and the alignment
+#include "Vector.h"
+#include "VectorAlgorithms.h"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Results of the kernels of NS on data, against the scalar ones
+#define KERNELS_AGREE(NS)                                                                           \
+    ((NS::sum(data, size) == simd::scalar::sum(data, size))                                        \
+     && ((size == 0) || (NS::min(data, size) == simd::scalar::min(data, size)))                    \
+     && ((size == 0) || (NS::max(data, size) == simd::scalar::max(data, size)))                    \
+     && (NS::find(data, size, value) == simd::scalar::find(data, size, value))                     \
+     && (NS::count(data, size, value) == simd::scalar::count(data, size, value)))
+
+template <typename T>
+bool kernelsAgree(const T* data, size_t size, T value)
+{
+    bool agree = true;
+#ifdef SIMD_X86
+    if (simd::isa() >= simd::ISA::SSE4)
+        agree = agree && KERNELS_AGREE(simd::sse4);
+    if (simd::isa() >= simd::ISA::AVX2)
+        agree = agree && KERNELS_AGREE(simd::avx2);
+#endif
+    return agree;
+}
+
+#undef KERNELS_AGREE
+
+// Every size up to a few blocks of the widest kernel, from an unaligned start, with the
+// extremes and the value searched at every position: in the blocks, in the tail, or absent
+template <typename T>
+bool allSizesAgree()
+{
+    constexpr size_t MAX_SIZE = 80;
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> values(-50, 50);
+    std::vector<T> buffer(MAX_SIZE + 1);
+    for (auto& v : buffer)
+        v = static_cast<T>(values(random)); // whole numbers: float sums are exact in any order
+    const T* data = buffer.data() + 1;
+    const T value = static_cast<T>(99);
+
+    for (size_t size = 0; size <= MAX_SIZE; ++size)
+    {
+        if (!kernelsAgree(data, size, value))
+            return false;
+        for (size_t position = 0; position < size; ++position)
+        {
+            std::vector<T> changed(buffer);
+            changed[1 + position] = value;
+            changed[1 + (position * 7) % size] = static_cast<T>(-1000);
+            changed[1 + size - 1 - position] = static_cast<T>(1000);
+            if (!kernelsAgree(changed.data() + 1, size, value))
+                return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    check(allSizesAgree<int32_t>(), "integer kernels of every size");
+    check(allSizesAgree<float>(), "float kernels of every size");
+
+    Vector<int32_t> empty;
+    check((simd::sum(empty) == 0) && (simd::find(empty, 1) == 0) && (simd::count(empty, 1) == 0), "empty vector");
+    simd::fill(empty, 3);
+    simd::copy(empty, empty);
+    bool thrown = false;
+    try
+    {
+        simd::min(empty);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "no minimum in an empty vector");
+
+    Vector<int32_t> numbers;
+    for (int32_t i = 0; i < 1000; ++i)
+        numbers.pushBack(i % 2 ? -i : i);
+    check(simd::sum(numbers) == -500, "sum");
+    check((simd::min(numbers) == -999) && (simd::max(numbers) == 998), "min and max");
+    check((simd::find(numbers, -777) == 777) && (simd::find(numbers, 5) == numbers.size()), "find");
+
+    // integers are summed in 64 bits
+    Vector<int32_t> large;
+    for (int i = 0; i < 100; ++i)
+        large.pushBack(INT32_MAX);
+    check(simd::sum(large) == int64_t{100} * INT32_MAX, "integer sum without overflow");
+
+    Vector<float> squares;
+    for (int i = 0; i < 37; ++i)
+        squares.pushBack(static_cast<float>(i));
+    simd::transform(squares, squares, [](float x) { return x * x; });
+    check((squares[36] == 1296.0f) && (simd::count(squares, 25.0f) == 1), "transform in place");
+    Vector<int32_t> tooSmall;
+    thrown = false;
+    try
+    {
+        simd::transform(numbers, tooSmall, [](int32_t x) { return x; });
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "output vector too small");
+
+    // fills of every size around a vector, and one streamed past the caches
+    bool allFilled = true;
+    for (size_t size = 0; size <= 40; ++size)
+    {
+        std::vector<int32_t> guarded(size + 2, -1);
+        std::span<int32_t> part(guarded.data() + 1, size);
+        simd::fill(part, 5);
+        allFilled = allFilled && (simd::count(guarded, 5) == size) && (guarded.front() == -1) && (guarded.back() == -1);
+    }
+    check(allFilled, "small fills stay in bounds");
+    std::vector<int32_t> filled(simd::streamingThreshold() / sizeof(int32_t) + 13);
+    std::span<int32_t> streamed(filled.data() + 1, filled.size() - 1);
+    simd::fill(streamed, 42);
+    check((simd::count(streamed, 42) == streamed.size()) && (filled[0] == 0), "streamed fill");
+
+    std::vector<int32_t> destination(numbers.size() + 1, 7);
+    simd::copy(numbers, destination);
+    check((destination[999] == -999) && (destination[1000] == 7), "copy");
+
+    std::cout << (failures ? "SIMD test failed!" : "SIMD test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
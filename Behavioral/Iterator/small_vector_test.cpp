@@ -0,0 +1,141 @@
+// Checks the moves of SmallVector between its inline storage and the heap
+#include "SmallVector.h"
+
+#include <iostream>
+#include <string>
+#include <utility>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Counts the live instances; not trivially relocatable
+struct Tracked
+{
+    Tracked(int value_)
+    : value(std::to_string(value_))
+    {
+        alive++;
+    }
+
+    Tracked(const Tracked& other)
+    : value(other.value)
+    {
+        alive++;
+    }
+
+    Tracked(Tracked&& other) noexcept
+    : value(std::move(other.value))
+    {
+        alive++;
+    }
+
+    Tracked& operator=(const Tracked&) = default;
+
+    ~Tracked()
+    {
+        alive--;
+    }
+
+    std::string value;
+    static inline int alive = 0;
+};
+
+typedef SmallVector<Tracked, 4> Small;
+
+Small filled(int count)
+{
+    Small v;
+    for (int i = 0; i < count; ++i)
+        v.emplaceBack(i);
+    return v;
+}
+
+bool holds(const Small& v, int count)
+{
+    if (static_cast<int>(v.size()) != count)
+        return false;
+    for (int i = 0; i < count; ++i)
+        if (v[i].value != std::to_string(i))
+            return false;
+    return true;
+}
+
+int main()
+{
+    {
+        Small v;
+        check(v.empty() && v.isInline() && (v.capacity() == 4), "empty and inline");
+        for (int i = 0; i < 4; ++i)
+            v.emplaceBack(i);
+        check(v.isInline() && holds(v, 4), "full and still inline");
+        v.emplaceBack(v[0]); // aliases an element moved by the growth
+        check(!v.isInline() && (v.size() == 5) && (v[4].value == "0"), "spilled to the heap");
+        v.popBack();
+        v.shrinkToFit();
+        check(v.isInline() && holds(v, 4), "back inline after shrinking");
+    }
+    check(Tracked::alive == 0, "elements destroyed");
+
+    // move construction, from inline and from heap storage
+    {
+        Small inlineSource = filled(3);
+        Small inlineMoved(std::move(inlineSource));
+        check(inlineMoved.isInline() && holds(inlineMoved, 3), "inline elements moved");
+        check(inlineSource.empty() && inlineSource.isInline(), "moved-from inline vector");
+
+        Small heapSource = filled(9);
+        const Tracked* storage = heapSource.data();
+        Small heapMoved(std::move(heapSource));
+        check((heapMoved.data() == storage) && holds(heapMoved, 9), "heap storage adopted");
+        check(heapSource.empty() && heapSource.isInline() && (heapSource.capacity() == 4), "moved-from heap vector");
+        heapSource.emplaceBack(0);
+        check(holds(heapSource, 1), "moved-from vector reused");
+    }
+    check(Tracked::alive == 0, "no element leaked by move construction");
+
+    // move assignment, every combination of storage
+    for (int from : {2, 7})
+        for (int to : {3, 11})
+        {
+            Small source = filled(from);
+            Small target = filled(to);
+            target = std::move(source);
+            // heap storage is adopted, inline elements are moved into the storage the target has
+            check(holds(target, from) && (target.isInline() == ((from <= 4) && (to <= 4))), "move assignment");
+            check(source.empty() && source.isInline(), "moved-from after assignment");
+        }
+    {
+        Small self = filled(6);
+        Small& alias = self;
+        self = std::move(alias);
+        check(holds(self, 6), "self move assignment");
+
+        Small copy(self);
+        Small other = filled(2);
+        other = self;
+        check(holds(copy, 6) && holds(other, 6) && holds(self, 6), "copies");
+        copy.clear();
+        copy.shrinkToFit();
+        check(copy.isInline() && copy.empty(), "cleared vector shrunk inline");
+    }
+    check(Tracked::alive == 0, "no element leaked by assignments");
+
+    // trivially relocatable elements are moved with memcpy
+    SmallVector<int, 2> ints {1, 2, 3};
+    check(!ints.isInline() && (ints[2] == 3), "initializer list beyond the inline capacity");
+    ints.popBack();
+    ints.shrinkToFit();
+    SmallVector<int, 2> intsMoved(std::move(ints));
+    check(intsMoved.isInline() && (intsMoved[0] == 1) && (intsMoved[1] == 2) && ints.empty(), "trivial elements moved inline");
+
+    std::cout << (failures ? "Small vector test failed!" : "Small vector test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
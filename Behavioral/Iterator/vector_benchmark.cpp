@@ -0,0 +1,154 @@
+// Vector against std::vector. Build with -DCMAKE_BUILD_TYPE=Release to get
+// meaningful numbers.
+#include "SmallVector.h"
+#include "SomeData.h"
+#include "Vector.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every heap allocation of the program is counted
+std::atomic<size_t> allocations {0};
+
+void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// Owns a heap object: moving it with memcpy is fine, so it opts in
+struct Resource
+{
+    std::unique_ptr<int> m_value;
+};
+
+template <>
+struct IsTriviallyRelocatable<Resource> : std::true_type
+{};
+
+template <typename T>
+T makeValue(size_t i);
+
+template <>
+int makeValue<int>(size_t i)
+{
+    return static_cast<int>(i);
+}
+
+template <>
+std::string makeValue<std::string>(size_t i)
+{
+    return "a string too long for the inline buffer " + std::to_string(i);
+}
+
+template <>
+SomeData makeValue<SomeData>(size_t i)
+{
+    return SomeData{makeValue<std::string>(i), i};
+}
+
+template <>
+Resource makeValue<Resource>(size_t i)
+{
+    return Resource{std::make_unique<int>(static_cast<int>(i))};
+}
+
+template <typename T>
+std::vector<T> makeValues(size_t count)
+{
+    std::vector<T> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        values.push_back(makeValue<T>(i));
+    return values;
+}
+
+// Moves count fresh values at the end of the vector made by makeVector, returns the time it took in ms
+template <typename T, typename MAKE_VECTOR>
+double pushBack(size_t count, bool reserve, MAKE_VECTOR makeVector)
+{
+    std::vector<T> values = makeValues<T>(count);
+    auto vector = makeVector();
+    if (reserve)
+        vector.reserve(count);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& value : values)
+    {
+        if constexpr (requires { vector.pushBack(std::move(value)); })
+            vector.pushBack(std::move(value));
+        else
+            vector.push_back(std::move(value));
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template <typename T>
+void benchmark(const char* name, size_t count)
+{
+    auto makeStd = [] { return std::vector<T>(); };
+    auto makeVector = [] { return Vector<T>(); };
+    std::cout << "  " << name << ": std::vector " << pushBack<T>(count, false, makeStd) << " ms, Vector "
+              << pushBack<T>(count, false, makeVector) << " ms; reserved: std::vector " << pushBack<T>(count, true, makeStd)
+              << " ms, Vector " << pushBack<T>(count, true, makeVector) << " ms";
+
+    // all the memory from one buffer, never given back while the vector lives
+    std::pmr::monotonic_buffer_resource arena;
+    std::cout << "; pmr::Vector on an arena " << pushBack<T>(count, false, [&] { return pmr::Vector<T>(&arena); }) << " ms" << std::endl;
+}
+
+// Builds count short-lived vectors of 1 to maxSize elements, each moved once, like a
+// function collecting a few results and returning them
+template <typename VECTOR>
+void benchmarkShort(const char* name, size_t count, size_t maxSize)
+{
+    size_t before = allocations.load();
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        VECTOR vector;
+        for (size_t j = 0; j <= i % maxSize; ++j)
+            vector.pushBack(static_cast<int>(i + j));
+        VECTOR result(std::move(vector));
+        total += result[result.size() - 1];
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << ": " << elapsed.count() << " ms, "
+              << static_cast<double>(allocations.load() - before) / count << " allocations/vector (checksum " << total << ")" << std::endl;
+}
+
+int main()
+{
+    std::cout << "Push back of prepared values:" << std::endl;
+    benchmark<int>("10M int", 10'000'000);
+    benchmark<std::string>("2M std::string", 2'000'000);
+    benchmark<SomeData>("2M SomeData", 2'000'000);
+    benchmark<Resource>("2M Resource (trivially relocatable)", 2'000'000);
+
+    std::cout << "10M short-lived vectors of 1 to 8 int:" << std::endl;
+    benchmarkShort<Vector<int>>("Vector", 10'000'000, 8);
+    benchmarkShort<SmallVector<int, 8>>("SmallVector<int, 8>", 10'000'000, 8);
+    std::cout << "10M short-lived vectors of 1 to 16 int, 8 inline:" << std::endl;
+    benchmarkShort<SmallVector<int, 8>>("SmallVector<int, 8>", 10'000'000, 16);
+}
@@ -0,0 +1,128 @@
+// Checks the growth, the moves and the allocators of Vector
+#include "Vector.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Copy throws once countdown reaches zero, and there is no move: growing copies
+struct Fragile
+{
+    explicit Fragile(int value_)
+    : value(value_)
+    {
+        alive++;
+    }
+
+    Fragile(const Fragile& other)
+    : value(other.value)
+    {
+        if (countdown-- == 0)
+            throw std::runtime_error("copy failed");
+        alive++;
+    }
+
+    ~Fragile()
+    {
+        alive--;
+    }
+
+    int value;
+    static inline int alive = 0;
+    static inline int countdown = 1000;
+};
+
+static_assert(std::is_nothrow_move_constructible_v<Vector<std::string>>);
+static_assert(std::is_nothrow_move_assignable_v<Vector<std::string>>);
+static_assert(!std::is_nothrow_move_assignable_v<pmr::Vector<std::string>>);
+static_assert(std::contiguous_iterator<Vector<int>::Iterator>);
+static_assert(std::contiguous_iterator<Vector<int>::ConstIterator>);
+
+int main()
+{
+    Vector<int> numbers;
+    check(numbers.empty() && (numbers.capacity() == 0) && (numbers.begin() == numbers.end()), "empty vector");
+    numbers.shrinkToFit();
+    numbers.popBack();
+    check(numbers.empty(), "empty vector unchanged");
+    for (int i = 0; i < 100; ++i)
+        numbers.pushBack(99 - i);
+    std::sort(numbers.begin(), numbers.end());
+    Vector<int>::ConstIterator first = numbers.begin();
+    check((first == numbers.cbegin()) && (numbers.cend() - first == 100), "const iterators");
+    check((numbers[0] == 0) && (numbers[99] == 99) && (std::accumulate(numbers.begin(), numbers.end(), 0) == 4950), "trivial elements");
+    numbers.popBack();
+    numbers.shrinkToFit();
+    check((numbers.capacity() == 99) && (numbers[98] == 98), "shrink to fit");
+
+    // relocation of elements owning memory, and an argument aliasing an element
+    Vector<std::string> strings {"a long string, allocated on the heap", "b"};
+    for (int i = 0; i < 20; ++i)
+        strings.emplaceBack(strings[0]);
+    check((strings.size() == 22) && (strings[21] == strings[0]) && (strings[1] == "b"), "relocated strings");
+    Vector<std::string> copy(strings);
+    Vector<std::string> moved(std::move(copy));
+    check(copy.empty() && (moved.size() == 22) && (moved[0] == strings[0]), "copy and move");
+    copy = moved;
+    moved = std::move(copy);
+    check(copy.empty() && (moved.size() == 22), "copy and move assignment");
+
+    // growth failing half way: the vector is left as it was
+    {
+        Vector<Fragile> fragile;
+        for (int i = 0; i < 4; ++i)
+            fragile.emplaceBack(i);
+        Fragile::countdown = 2;
+        bool thrown = false;
+        try
+        {
+            fragile.emplaceBack(4);
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        Fragile::countdown = 1000;
+        check(thrown && (fragile.size() == 4) && (fragile.capacity() == 4) && (fragile[3].value == 3), "strong guarantee when growing");
+        check(Fragile::alive == 4, "no element leaked by the failed growth");
+    }
+    check(Fragile::alive == 0, "elements destroyed");
+
+    // polymorphic allocators: the storage comes from the resource
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    pmr::Vector<int> local(&arena);
+    for (int i = 0; i < 200; ++i)
+        local.pushBack(i);
+    check((local.data() >= reinterpret_cast<int*>(buffer)) && (local.data() < reinterpret_cast<int*>(buffer + sizeof(buffer))), "storage in the arena");
+    check(local.getAllocator().resource() == &arena, "allocator kept");
+
+    pmr::Vector<int> elsewhere; // default resource
+    elsewhere = std::move(local);
+    check((elsewhere.size() == 200) && (elsewhere[199] == 199) && local.empty(), "move between resources");
+    check(elsewhere.getAllocator().resource() == std::pmr::get_default_resource(), "resource not propagated");
+    pmr::Vector<int> same(&arena);
+    same.pushBack(1);
+    int* storage = same.data();
+    pmr::Vector<int> target(&arena);
+    target = std::move(same);
+    check((target.data() == storage) && same.empty(), "storage handed over within a resource");
+
+    std::cout << (failures ? "Vector test failed!" : "Vector test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
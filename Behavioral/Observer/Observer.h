@@ -0,0 +1,493 @@
+#pragma once
+
+#include "SeqLock.h"
+#include "SnapshotList.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Observable;
+struct Observer
+{
+    virtual ~Observer() = default;
+    virtual void update(Observable&) = 0;
+};
+
+
+// Progress of an observer notified asynchronously
+struct ObserverLag
+{
+    uint64_t delivered {0}; // updates the observer was called for
+    uint64_t skipped {0};   // updates coalesced into a later one, never seen
+    uint64_t behind {0};    // updates published since the last one it was called for
+};
+
+
+/*
+ * Notifies the observers synchronously, or on a thread pool once given one:
+ * each observer then gets the latest update only, see lag().
+ */
+class Observable
+{
+public:
+    virtual ~Observable()
+    {
+        drain();
+    }
+    virtual void addObserver(Observer* obs)
+    {
+        entries.add(Entry{obs, std::make_shared<Slot>(obs, version.load())});
+    }
+    virtual void removeObserver(Observer* obs)
+    {
+        // from an update, waiting for the readers would wait for itself
+        bool deferred = delivering || (snapshotReadDepth > 0);
+        std::shared_ptr<Slot> slot;
+        entries.removeIf([&](const Entry& e)
+        {
+            if (e.observer != obs)
+                return false;
+            slot = e.slot;
+            slot->removed.store(true);
+            if (deferred)
+            {
+                std::lock_guard lock(removedMutex);
+                std::erase_if(removedSlots, [](const std::shared_ptr<Slot>& s) { return !s->scheduled.load(); });
+                removedSlots.push_back(slot);
+                removedFromUpdate.store(true);
+            }
+            return true;
+        });
+        if (deferred)
+            return;
+        if (slot)
+        {
+            entries.synchronize();
+            waitIdle(*slot);
+        }
+        waitRemoved([obs](const Slot& s) { return s.observer == obs; });
+    }
+    virtual void notify(Observer* obs)
+    {
+        obs->update(*this);
+    }
+    virtual void notifyAll()
+    {
+        auto snapshot = entries.read();
+        if (!pool)
+        {
+            for (const auto& e : snapshot)
+                if (!e.slot->removed.load(std::memory_order_relaxed))
+                    e.observer->update(*this);
+            return;
+        }
+
+        uint64_t v = version.fetch_add(1) + 1;
+        for (const auto& e : snapshot)
+        {
+            raise(e.slot->latest, v);
+            if (!e.slot->scheduled.exchange(true))
+                pool->post([this, slot = e.slot] { deliver(*slot); });
+        }
+    }
+
+    // nullptr switches back to synchronous notifications
+    void setThreadPool(ThreadPool* pool_)
+    {
+        drain();
+        pool = pool_;
+    }
+
+    // Waits until the observers have seen the last update, once the producer stopped
+    void drain()
+    {
+        std::vector<std::shared_ptr<Slot>> slots;
+        for (const auto& e : entries.read())
+            slots.push_back(e.slot);
+        for (const auto& slot : slots)
+            waitIdle(*slot);
+        waitRemoved([](const Slot&) { return true; });
+    }
+
+    ObserverLag lag(Observer* obs) const
+    {
+        for (const auto& e : entries.read())
+            if (e.observer == obs)
+                return ObserverLag{e.slot->delivered.load(), e.slot->skipped.load(), version.load() - e.slot->seen.load()};
+        return {};
+    }
+
+private:
+    struct Slot
+    {
+        Slot(Observer* observer_, uint64_t seen_)
+        : observer(observer_)
+        , seen(seen_)
+        , latest(seen_)
+        {}
+
+        Observer* const observer;
+        std::atomic<uint64_t> seen;   // version of the last update delivered
+        std::atomic<uint64_t> latest; // version of the last update published
+        std::atomic<uint64_t> delivered {0};
+        std::atomic<uint64_t> skipped {0};
+        std::atomic<bool> scheduled {false}; // a delivery is queued or running
+        std::atomic<bool> removed {false};
+    };
+
+    struct Entry
+    {
+        Observer* observer;
+        std::shared_ptr<Slot> slot;
+    };
+
+    // Runs on the pool
+    void deliver(Slot& slot)
+    {
+        delivering = true;
+        while (true)
+        {
+            uint64_t v = slot.latest.load();
+            if (!slot.removed.load() && (v > slot.seen.load()))
+            {
+                slot.observer->update(*this);
+                slot.skipped.fetch_add(v - slot.seen.load() - 1);
+                slot.seen.store(v);
+                slot.delivered.fetch_add(1);
+            }
+            slot.scheduled.store(false);
+            if ((slot.latest.load() <= v) || slot.scheduled.exchange(true))
+                break;
+        }
+        slot.scheduled.notify_all();
+        delivering = false;
+    }
+
+    static void raise(std::atomic<uint64_t>& value, uint64_t v)
+    {
+        uint64_t current = value.load();
+        while ((current < v) && !value.compare_exchange_weak(current, v))
+            ;
+    }
+
+    static void waitIdle(Slot& slot)
+    {
+        while (slot.scheduled.load())
+            slot.scheduled.wait(true);
+    }
+
+    // Waits for the observers removed from an update
+    template <typename PRED>
+    void waitRemoved(PRED pred)
+    {
+        if (removedFromUpdate.exchange(false))
+            entries.synchronize();
+
+        std::vector<std::shared_ptr<Slot>> slots;
+        {
+            std::lock_guard lock(removedMutex);
+            std::erase_if(removedSlots, [&](const std::shared_ptr<Slot>& slot)
+            {
+                if (!pred(*slot))
+                    return false;
+                slots.push_back(slot);
+                return true;
+            });
+        }
+        for (const auto& slot : slots)
+            waitIdle(*slot);
+    }
+
+    static inline thread_local bool delivering {false};
+
+    SnapshotList<Entry> entries;
+    std::mutex removedMutex;
+    std::vector<std::shared_ptr<Slot>> removedSlots;
+    std::atomic<bool> removedFromUpdate {false};
+    std::atomic<uint64_t> version {0};
+    ThreadPool* pool {nullptr};
+};
+
+
+enum class WEATHER_FIELD : uint8_t
+{
+    TEMPERATURE = 1,
+    SKY = 2
+};
+
+constexpr uint8_t ALL_WEATHER_FIELDS = 1 | 2;
+
+// What a setWeather() call changed, with the new values
+struct WeatherChange
+{
+    bool has(WEATHER_FIELD field) const
+    {
+        return changed & static_cast<uint8_t>(field);
+    }
+
+    uint8_t changed; // mask of WEATHER_FIELD values
+    int temperatureCelsius;
+    std::string_view sky; // only valid during the call
+};
+
+struct WeatherListener
+{
+    virtual ~WeatherListener() = default;
+    virtual void weatherChanged(const WeatherChange&) = 0;
+};
+
+
+typedef uint8_t SkyId;
+
+// Sky descriptions interned as small ids. Names are never removed, so they are read without locks.
+class SkyNames
+{
+public:
+    static constexpr size_t CAPACITY = 256;
+
+    // Callers must be serialized
+    SkyId intern(std::string_view name)
+    {
+        size_t n = count.load(std::memory_order_relaxed);
+        for (size_t id = 0; id < n; ++id)
+            if (names[id] == name)
+                return static_cast<SkyId>(id);
+        if (n == CAPACITY)
+            throw std::runtime_error("Too many sky descriptions!");
+        names[n] = name;
+        count.store(n + 1, std::memory_order_release);
+        return static_cast<SkyId>(n);
+    }
+
+    std::string_view name(SkyId id) const
+    {
+        if (id >= count.load(std::memory_order_acquire))
+            return {};
+        return names[id];
+    }
+
+private:
+    std::array<std::string, CAPACITY> names;
+    std::atomic<size_t> count {0};
+};
+
+// Fixed-size copy of the weather, consistent as a whole
+struct WeatherState
+{
+    uint64_t version {0}; // setWeather() calls so far
+    int32_t temperatureCelsius {0};
+    SkyId sky {0};
+};
+
+
+/*
+ * Besides the observers, listeners subscribed to a set of fields are called
+ * with the new values, after the observers, when one of these fields changed.
+ * getState() gives a consistent copy of the weather without locking.
+ */
+class WeatherProvider : public Observable
+{
+public:
+    ~WeatherProvider()
+    {
+        drain(); // asynchronous observers may still be reading the weather
+    }
+
+    void setWeather(int temperatureCelsius, std::string sky)
+    {
+        uint8_t changed = ALL_WEATHER_FIELDS;
+        {
+            std::lock_guard lock(mutex);
+            if (initialized)
+            {
+                changed = 0;
+                if (temperatureCelsius != tempInCelsius)
+                    changed |= static_cast<uint8_t>(WEATHER_FIELD::TEMPERATURE);
+                if (sky != skyStatus)
+                    changed |= static_cast<uint8_t>(WEATHER_FIELD::SKY);
+            }
+            initialized = true;
+            tempInCelsius = temperatureCelsius;
+            skyStatus = sky;
+
+            if (changed & static_cast<uint8_t>(WEATHER_FIELD::SKY))
+                skyId = skyNames.intern(sky);
+            state.store(WeatherState{++version, temperatureCelsius, skyId});
+        }
+
+        notifyAll();
+        if (!changed)
+            return;
+
+        WeatherChange change{changed, temperatureCelsius, sky};
+        for (uint8_t fields = 1; fields <= ALL_WEATHER_FIELDS; ++fields)
+            if (fields & changed)
+                for (const auto& s : listeners[fields].read())
+                    if (!s.cancelled->load(std::memory_order_relaxed))
+                        s.listener->weatherChanged(change);
+    }
+
+    // fields is a mask of WEATHER_FIELD values, a listener is subscribed once
+    void subscribe(WeatherListener* listener, uint8_t fields)
+    {
+        if (fields & ALL_WEATHER_FIELDS)
+            listeners[fields & ALL_WEATHER_FIELDS].add(Subscription{listener, std::make_shared<std::atomic<bool>>(false)});
+    }
+
+    // Once it returns the listener is never called again. From a callback, the
+    // calls already running on other threads may still complete.
+    void unsubscribe(WeatherListener* listener)
+    {
+        for (auto& group : listeners)
+        {
+            bool found = group.removeIf([listener](const Subscription& s)
+            {
+                if (s.listener != listener)
+                    return false;
+                s.cancelled->store(true); // skipped by the setWeather() calls in progress
+                return true;
+            });
+            if (found)
+            {
+                group.synchronize();
+                return;
+            }
+        }
+    }
+
+    WeatherState getState() const
+    {
+        return state.load();
+    }
+
+    std::string_view getSkyName(SkyId sky) const
+    {
+        return skyNames.name(sky);
+    }
+
+    int getTemperatureInCelsius()
+    {
+        std::lock_guard lock(mutex);
+        return tempInCelsius;
+    }
+
+    std::string getSkyStatus()
+    {
+        std::lock_guard lock(mutex);
+        return skyStatus;
+    }
+
+private:
+    struct Subscription
+    {
+        WeatherListener* listener;
+        std::shared_ptr<std::atomic<bool>> cancelled; // shared by the snapshots holding it
+    };
+
+    std::mutex mutex;
+    bool initialized {false};
+    int tempInCelsius;
+    std::string skyStatus;
+    std::array<SnapshotList<Subscription>, ALL_WEATHER_FIELDS + 1> listeners; // indexed by set of fields
+
+    SkyNames skyNames;
+    SkyId skyId {0};
+    uint64_t version {0};
+    SeqLock<WeatherState> state;
+};
+
+
+class InformationScreen : public Observer
+{
+public:
+    explicit InformationScreen(WeatherProvider& weather_)
+        : weather(weather_)
+    {
+        weather.addObserver(this);
+    }
+
+    ~InformationScreen()
+    {
+        weather.removeObserver(this);
+    }
+
+    void update(Observable& updatedObservable) override
+    {
+        if (&updatedObservable == &weather)
+        {
+            printWeatherNow();
+        }
+    }
+
+    void printWeatherNow()
+    {
+        std::cout << "Temperature: " << weather.getTemperatureInCelsius() << " degree, " << weather.getSkyStatus() << std::endl;
+    }
+
+private:
+    WeatherProvider& weather;
+};
+
+
+class SmartHomeControl : public WeatherListener
+{
+public:
+    explicit SmartHomeControl(WeatherProvider& weather_)
+        : weather(weather_)
+    {
+        weather.subscribe(this, ALL_WEATHER_FIELDS);
+    }
+
+    ~SmartHomeControl()
+    {
+        weather.unsubscribe(this);
+    }
+
+    // Only called when the weather changed
+    void weatherChanged(const WeatherChange& change) override
+    {
+        if (change.has(WEATHER_FIELD::TEMPERATURE))
+            temp = change.temperatureCelsius;
+        if (change.has(WEATHER_FIELD::SKY))
+            raining = (change.sky == "raining");
+
+        bool closeTheWindows = widowsOpen && raining;
+        if (closeTheWindows) closeWindows();
+
+        if (temp >= 25)
+        {
+            if (!closeTheWindows) openWindows();
+            if (heatingSystemON) heatOFF();
+        }
+        else if (temp < 21)
+        {
+            if (widowsOpen) closeWindows();
+            if (temp < 16)
+            {
+                if (!heatingSystemON) heatON();
+            }
+        }
+    }
+
+    void openWindows() { std::cout << "Opening all windows..." << std::endl; widowsOpen = true; }
+    void closeWindows() { std::cout << "Closing all windows..." << std::endl;  widowsOpen = false; }
+    void heatON() { std::cout << "Warming-up the house..." << std::endl; heatingSystemON = true; }
+    void heatOFF() { std::cout << "Stop heating system..." << std::endl; heatingSystemON = false; }
+
+private:
+    WeatherProvider& weather;
+    int temp {0};
+    bool raining {false};
+    bool heatingSystemON {false};
+    bool widowsOpen{ false };
+};
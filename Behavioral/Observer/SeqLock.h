@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Value published by one writer at a time and read by any number of threads
+ * without locks (sequence lock): readers retry while it is being written.
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word!");
+
+public:
+    explicit SeqLock(const T& value = {})
+    {
+        store(value);
+    }
+
+    // Writers must be serialized by the caller
+    void store(const T& value)
+    {
+        Buffer buffer {};
+        memcpy(buffer.data(), &value, sizeof(T));
+
+        uint64_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); // odd sequence visible before the words
+        for (size_t i = 0; i < WORDS; ++i)
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    T load() const
+    {
+        Buffer buffer;
+        while (true)
+        {
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                continue; // write in progress
+            for (size_t i = 0; i < WORDS; ++i)
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire); // words read before checking again
+            if (sequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+
+        T value;
+        memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T)); // T is trivially copyable, not trivial
+        return value;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    typedef std::array<uint64_t, WORDS> Buffer;
+
+    std::atomic<uint64_t> sequence {0};
+    std::array<std::atomic<uint64_t>, WORDS> words {};
+};
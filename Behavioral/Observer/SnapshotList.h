@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Read guards of any SnapshotList held by the calling thread
+inline thread_local unsigned snapshotReadDepth = 0;
+
+// Threads that ever read a SnapshotList, to spread them over the reader counters
+inline std::atomic<size_t> snapshotReaderThreads {0};
+inline thread_local const size_t snapshotReaderThread = snapshotReaderThreads.fetch_add(1);
+
+/*
+ * List read without locks while others modify it (read-copy-update): writers
+ * publish a modified copy, the old one is freed once no reader holds it.
+ */
+template <typename T>
+class SnapshotList
+{
+    static constexpr size_t SHARDS = 16;
+
+    struct alignas(64) ReaderShard
+    {
+        std::array<std::atomic<uint32_t>, 2> count {};
+    };
+
+public:
+    typedef std::vector<T> Snapshot;
+
+    // Keeps the snapshot alive while in scope: must not outlive the list
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const SnapshotList& list_)
+        : list(list_)
+        , shard(list_.readers[snapshotReaderThread % SHARDS])
+        {
+            while (true)
+            {
+                epoch = list.epoch.load();
+                shard.count[epoch & 1].fetch_add(1);
+                if (list.epoch.load() == epoch)
+                    break;
+                list.leave(shard, epoch); // flipped meanwhile: retry on the other side
+            }
+            snapshot = list.current.load();
+            snapshotReadDepth++;
+        }
+
+        ~ReadGuard()
+        {
+            snapshotReadDepth--;
+            list.leave(shard, epoch);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        typename Snapshot::const_iterator begin() const { return snapshot->begin(); }
+        typename Snapshot::const_iterator end() const { return snapshot->end(); }
+        size_t size() const { return snapshot->size(); }
+
+    private:
+        const SnapshotList& list;
+        ReaderShard& shard;
+        uint64_t epoch;
+        const Snapshot* snapshot;
+    };
+
+    SnapshotList() = default;
+
+    ~SnapshotList()
+    {
+        for (const auto& r : retired)
+            delete r.snapshot;
+        delete current.load();
+    }
+
+    SnapshotList(const SnapshotList&) = delete;
+    SnapshotList& operator=(const SnapshotList&) = delete;
+
+    ReadGuard read() const
+    {
+        return ReadGuard(*this);
+    }
+
+    void add(T value)
+    {
+        std::lock_guard lock(writer);
+        auto copy = new Snapshot(*current.load());
+        copy->push_back(std::move(value));
+        publish(copy);
+    }
+
+    // Removes the first element matching pred, returns whether there was one
+    template <typename PRED>
+    bool removeIf(PRED pred)
+    {
+        std::lock_guard lock(writer);
+        const Snapshot* old = current.load();
+        auto copy = new Snapshot;
+        copy->reserve(old->size());
+        bool found = false;
+        for (const auto& value : *old)
+        {
+            if (!found && pred(value))
+                found = true;
+            else
+                copy->push_back(value);
+        }
+        if (!found)
+        {
+            delete copy;
+            return false;
+        }
+        publish(copy);
+        return true;
+    }
+
+    // Blocks until no reader can see the elements removed so far, false from a read
+    bool synchronize()
+    {
+        if (snapshotReadDepth > 0)
+            return false;
+
+        uint64_t target = epoch.load() + 2;
+        waiting.fetch_add(1);
+        while (true)
+        {
+            uint64_t e;
+            {
+                std::lock_guard lock(writer);
+                advance();
+                e = epoch.load();
+            }
+            if (e >= target)
+                break;
+            epoch.wait(e); // flipped by the last reader of the previous epoch
+        }
+        waiting.fetch_sub(1);
+        return true;
+    }
+
+private:
+    struct Retired
+    {
+        const Snapshot* snapshot;
+        uint64_t epoch; // at which it was replaced
+    };
+
+    void publish(const Snapshot* copy)
+    {
+        retired.push_back(Retired{current.exchange(copy), epoch.load()});
+        advance();
+    }
+
+    void leave(ReaderShard& shard, uint64_t e) const
+    {
+        if ((shard.count[e & 1].fetch_sub(1) == 1) && (waiting.load() > 0))
+            flip();
+    }
+
+    // Moves to the next epoch if no reader of the previous one is left
+    bool flip() const
+    {
+        uint64_t e = epoch.load();
+        uint64_t active = 0;
+        for (const auto& shard : readers)
+            active += shard.count[(e - 1) & 1].load();
+        if ((active != 0) || !epoch.compare_exchange_strong(e, e + 1))
+            return false;
+        if (waiting.load() > 0)
+            epoch.notify_all();
+        return true;
+    }
+
+    // Flips the epoch as far as the readers allow, then frees the old snapshots
+    void advance()
+    {
+        if (flip())
+            flip();
+
+        uint64_t e = epoch.load();
+        std::erase_if(retired, [e](const Retired& r)
+        {
+            if (r.epoch + 2 > e)
+                return false;
+            delete r.snapshot;
+            return true;
+        });
+    }
+
+    std::atomic<const Snapshot*> current {new Snapshot};
+    mutable std::atomic<uint64_t> epoch {1}; // flipped by writers, and by readers when a writer waits
+    std::atomic<uint32_t> waiting {0};       // threads in synchronize()
+    mutable std::array<ReaderShard, SHARDS> readers {};
+    std::mutex writer;
+    std::vector<Retired> retired; // under writer
+};
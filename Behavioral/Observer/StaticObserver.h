@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Observable whose observers, or ranges of observers, are known at compile time, e.g.
+ * StaticObservable<WeatherState, InformationPanel, std::vector<Thermostat>>.
+ */
+template <typename STATE, typename... OBSERVERS>
+class StaticObservable
+{
+public:
+    explicit StaticObservable(OBSERVERS&... observers_)
+    : observers(observers_...)
+    {}
+
+    void notifyAll(const STATE& state)
+    {
+        std::apply([&](auto&... observer) { (dispatch(observer, state), ...); }, observers);
+    }
+
+private:
+    template <typename OBSERVER>
+    static void dispatch(OBSERVER& observer, const STATE& state)
+    {
+        if constexpr (std::ranges::range<OBSERVER>)
+        {
+            for (auto& o : observer)
+                o.update(state);
+        }
+        else
+            observer.update(state);
+    }
+
+    std::tuple<OBSERVERS&...> observers;
+};
+
+
+template <typename SIGNATURE, size_t CAPACITY = 32>
+class Delegate;
+
+/*
+ * Callable stored by value in a buffer of CAPACITY bytes, unlike std::function.
+ * Copying a delegate holding a move-only callable throws.
+ */
+template <typename R, typename... ARGS, size_t CAPACITY>
+class Delegate<R(ARGS...), CAPACITY>
+{
+public:
+    template <typename F>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, Delegate> && std::is_invocable_r_v<R, F&, ARGS...>)
+    Delegate(F&& f)
+    {
+        typedef std::remove_cvref_t<F> Type;
+        static_assert(sizeof(Type) <= CAPACITY, "Callable too large for the inline buffer!");
+        static_assert(alignof(Type) <= alignof(std::max_align_t), "Callable over-aligned for the inline buffer!");
+        static_assert(std::is_nothrow_move_constructible_v<Type>, "Callables must be nothrow movable!");
+
+        new (storage) Type(std::forward<F>(f));
+        operations = &OPERATIONS<Type>;
+    }
+
+    Delegate(const Delegate& other)
+    : operations(other.operations)
+    {
+        if (!operations->copy)
+            throw std::runtime_error("Unable to copy a delegate holding a move-only callable!");
+        operations->copy(storage, other.storage);
+    }
+
+    Delegate(Delegate&& other) noexcept
+    : operations(other.operations)
+    {
+        operations->move(storage, other.storage);
+    }
+
+    Delegate& operator=(Delegate other) noexcept
+    {
+        operations->destroy(storage);
+        operations = other.operations;
+        operations->move(storage, other.storage);
+        return *this;
+    }
+
+    ~Delegate()
+    {
+        operations->destroy(storage);
+    }
+
+    R operator()(ARGS... args)
+    {
+        return operations->invoke(storage, std::forward<ARGS>(args)...);
+    }
+
+private:
+    struct Operations
+    {
+        R (*invoke)(void*, ARGS&&...);
+        void (*copy)(void* to, const void* from); // nullptr if F is move-only
+        void (*move)(void* to, void* from);
+        void (*destroy)(void*);
+    };
+
+    template <typename F>
+    static constexpr auto copier() -> void (*)(void*, const void*)
+    {
+        if constexpr (std::is_copy_constructible_v<F>)
+            return [](void* to, const void* from) { new (to) F(*static_cast<const F*>(from)); };
+        else
+            return nullptr;
+    }
+
+    template <typename F>
+    static constexpr Operations OPERATIONS =
+    {
+        [](void* p, ARGS&&... args) -> R { return (*static_cast<F*>(p))(std::forward<ARGS>(args)...); },
+        copier<F>(),
+        [](void* to, void* from) { new (to) F(std::move(*static_cast<F*>(from))); },
+        [](void* p) { static_cast<F*>(p)->~F(); }
+    };
+
+    alignas(std::max_align_t) std::byte storage[CAPACITY];
+    const Operations* operations;
+};
+
+
+// Observers registered at run time as delegates getting the new state
+template <typename STATE, size_t CAPACITY = 32>
+class DelegateObservable
+{
+public:
+    typedef Delegate<void(const STATE&), CAPACITY> Callback;
+
+    // Returns the id to unsubscribe with
+    size_t subscribe(Callback callback)
+    {
+        (notifying ? added : subscribers).push_back(Subscriber{nextId, std::move(callback)});
+        return nextId++;
+    }
+
+    void unsubscribe(size_t id)
+    {
+        auto matches = [id](const Subscriber& s) { return s.id == id; };
+        std::erase_if(added, matches);
+        if (!notifying)
+        {
+            std::erase_if(subscribers, matches);
+            return;
+        }
+        // The loop in notifyAll() is running: skip the subscriber, erase it afterwards
+        for (auto& s : subscribers)
+            if (matches(s))
+                s.removed = true;
+    }
+
+    void notifyAll(const STATE& state)
+    {
+        ++notifying;
+        for (auto& s : subscribers)
+            if (!s.removed)
+                s.callback(state);
+        if (--notifying == 0)
+        {
+            std::erase_if(subscribers, [](const Subscriber& s) { return s.removed; });
+            std::move(added.begin(), added.end(), std::back_inserter(subscribers));
+            added.clear();
+        }
+    }
+
+private:
+    struct Subscriber
+    {
+        size_t id;
+        Callback callback;
+        bool removed {false};
+    };
+
+    std::vector<Subscriber> subscribers;
+    std::vector<Subscriber> added; // subscribed during a notification
+    size_t notifying {0};          // depth of the notifyAll() calls running
+    size_t nextId {0};
+};
@@ -0,0 +1,113 @@
+// Checks the static observable, the delegates and the delegate-based observable
+#include "StaticObserver.h"
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+struct Panel
+{
+    void update(int state) { last = state; }
+    int last {0};
+};
+
+struct Counter
+{
+    void update(int) { calls++; }
+    int calls {0};
+};
+
+int main()
+{
+    Panel panel;
+    std::vector<Counter> counters(3);
+    StaticObservable<int, Panel, std::vector<Counter>> observable(panel, counters);
+    observable.notifyAll(5);
+    observable.notifyAll(6);
+    check((panel.last == 6) && (counters[0].calls == 2) && (counters[2].calls == 2), "static observers notified");
+
+    int total = 0;
+    Delegate<void(int)> add([&total](int n) { total += n; });
+    Delegate<void(int)> copy(add);
+    add(2);
+    copy(3);
+    check(total == 5, "copied delegate");
+
+    Delegate<int()> owner([p = std::make_unique<int>(7)] { return *p; });
+    Delegate<int()> moved(std::move(owner));
+    check(moved() == 7, "move-only callable moved");
+    bool thrown = false;
+    try
+    {
+        Delegate<int()> copied(moved);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "copy of a move-only callable refused");
+    Delegate<int()> assigned([] { return 1; });
+    assigned = std::move(moved);
+    check(assigned() == 7, "move assignment");
+    assigned = [] { return 2; };
+    check(assigned() == 2, "assignment of a callable");
+
+    DelegateObservable<int, 64> delegates;
+    std::vector<int> calls;
+    size_t first = delegates.subscribe([&calls](int s) { calls.push_back(s); });
+    size_t second = 0;
+    size_t late = 0;
+    bool subscribed = false;
+    // at its first call: unsubscribes the first delegate and itself, subscribes another one
+    second = delegates.subscribe([&](int s)
+    {
+        calls.push_back(10 + s);
+        delegates.unsubscribe(first);
+        delegates.unsubscribe(second);
+        if (!subscribed)
+        {
+            subscribed = true;
+            late = delegates.subscribe([&calls](int s) { calls.push_back(100 + s); });
+        }
+    });
+    size_t third = delegates.subscribe([&calls](int s) { calls.push_back(20 + s); });
+    delegates.notifyAll(1);
+    check((calls == std::vector<int>{1, 11, 21}), "delegates removed during a notification still run once");
+    delegates.notifyAll(2);
+    check((calls == std::vector<int>{1, 11, 21, 22, 102}), "removed delegates skipped, added ones called next time");
+
+    // nested notification from a delegate: removals wait for the outer one
+    calls.clear();
+    delegates.unsubscribe(late);
+    bool nested = false;
+    size_t nesting = delegates.subscribe([&](int s)
+    {
+        if (!nested)
+        {
+            nested = true;
+            delegates.unsubscribe(third);
+            delegates.notifyAll(s + 1);
+        }
+    });
+    delegates.notifyAll(3);
+    check((calls == std::vector<int>{23}), "nested notification");
+    delegates.unsubscribe(nesting);
+    delegates.notifyAll(4);
+    check((calls == std::vector<int>{23}), "all delegates unsubscribed");
+
+    std::cout << (failures ? "Delegate test failed!" : "Delegate test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+// Checks that weather listeners are only called for the fields they subscribed to, when they change
+#include "Observer.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+struct RecordingListener : WeatherListener
+{
+    void weatherChanged(const WeatherChange& change) override
+    {
+        changes.push_back(change.changed);
+        temperature = change.temperatureCelsius;
+        sky = std::string(change.sky);
+    }
+
+    std::vector<uint8_t> changes;
+    int temperature {0};
+    std::string sky;
+};
+
+// Unsubscribes itself, and another listener, from its first call
+struct LeavingListener : WeatherListener
+{
+    LeavingListener(WeatherProvider& weather_, WeatherListener* other_)
+    : weather(weather_)
+    , other(other_)
+    {}
+
+    void weatherChanged(const WeatherChange&) override
+    {
+        calls++;
+        weather.unsubscribe(this);
+        weather.unsubscribe(other);
+    }
+
+    WeatherProvider& weather;
+    WeatherListener* other;
+    int calls {0};
+};
+
+int main()
+{
+    constexpr uint8_t TEMPERATURE = static_cast<uint8_t>(WEATHER_FIELD::TEMPERATURE);
+    constexpr uint8_t SKY = static_cast<uint8_t>(WEATHER_FIELD::SKY);
+
+    WeatherProvider weather;
+    RecordingListener temperature, sky, both, none;
+    weather.subscribe(&temperature, TEMPERATURE);
+    weather.subscribe(&sky, SKY);
+    weather.subscribe(&both, ALL_WEATHER_FIELDS);
+    weather.subscribe(&none, 0);
+
+    weather.setWeather(20, "sunny");
+    check((temperature.changes.size() == 1) && (sky.changes.size() == 1) && (both.changes.size() == 1), "first weather notifies everyone");
+    check((both.changes.back() == ALL_WEATHER_FIELDS) && (both.temperature == 20) && (both.sky == "sunny"), "first weather values");
+
+    weather.setWeather(20, "sunny");
+    check((temperature.changes.size() == 1) && (sky.changes.size() == 1) && (both.changes.size() == 1), "no call without change");
+
+    weather.setWeather(22, "sunny");
+    check((temperature.changes.size() == 2) && (sky.changes.size() == 1) && (both.changes.size() == 2), "temperature change");
+    check((both.changes.back() == TEMPERATURE) && (temperature.temperature == 22), "temperature change values");
+
+    weather.setWeather(22, "raining");
+    check((temperature.changes.size() == 2) && (sky.changes.size() == 2) && (sky.sky == "raining"), "sky change");
+    check(none.changes.empty(), "no fields, no calls");
+
+    WeatherState state = weather.getState();
+    check((state.version == 4) && (state.temperatureCelsius == 22) && (weather.getSkyName(state.sky) == "raining"), "state copy");
+    check(weather.getSkyName(200).empty(), "unknown sky id");
+
+    LeavingListener leaving(weather, &both);
+    weather.subscribe(&leaving, ALL_WEATHER_FIELDS);
+    weather.setWeather(10, "cloudy");
+    weather.setWeather(11, "snowing");
+    check(leaving.calls == 1, "unsubscribed from its own call");
+    check(both.changes.size() == 4, "unsubscribed from another listener's call");
+    check(temperature.changes.size() == 4, "other listeners still called");
+
+    weather.unsubscribe(&temperature);
+    weather.unsubscribe(&temperature); // no longer subscribed
+    weather.setWeather(12, "snowing");
+    check(temperature.changes.size() == 4, "no call after unsubscribing");
+
+    std::cout << (failures ? "Field subscription test failed!" : "Field subscription test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
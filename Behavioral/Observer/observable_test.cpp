@@ -0,0 +1,115 @@
+// Checks the synchronous and the coalesced asynchronous notifications of Observable
+#include "Observer.h"
+
+#include <atomic>
+#include <future>
+#include <iostream>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+struct CountingObserver : Observer
+{
+    void update(Observable&) override
+    {
+        updates++;
+    }
+
+    std::atomic<int> updates {0};
+};
+
+// Blocks in its first update until released, so the next ones pile up
+struct BlockedObserver : Observer
+{
+    void update(Observable&) override
+    {
+        if (updates++ == 0)
+        {
+            entered.set_value();
+            release.get_future().wait();
+        }
+    }
+
+    std::atomic<int> updates {0};
+    std::promise<void> entered;
+    std::promise<void> release;
+};
+
+// Removes itself from its first update
+struct LeavingObserver : Observer
+{
+    void update(Observable& observable) override
+    {
+        updates++;
+        observable.removeObserver(this);
+    }
+
+    std::atomic<int> updates {0};
+};
+
+int main()
+{
+    Observable observable;
+    CountingObserver counting;
+    observable.addObserver(&counting);
+    observable.notifyAll();
+    check(counting.updates == 1, "synchronous notification");
+    check(observable.lag(nullptr).delivered == 0, "no lag for an unknown observer");
+
+    LeavingObserver leaving;
+    observable.addObserver(&leaving);
+    observable.notifyAll();
+    observable.notifyAll();
+    check((leaving.updates == 1) && (counting.updates == 3), "synchronous removal from an update");
+
+    ThreadPool pool(2);
+    observable.setThreadPool(&pool);
+    BlockedObserver blocked;
+    observable.addObserver(&blocked);
+    observable.notifyAll();
+    blocked.entered.get_future().wait();
+    for (int i = 0; i < 9; ++i)
+        observable.notifyAll();
+    check(observable.lag(&blocked).behind > 0, "blocked observer behind");
+    blocked.release.set_value();
+    observable.drain();
+
+    ObserverLag lag = observable.lag(&blocked);
+    check(blocked.updates == 2, "updates coalesced while blocked");
+    check((lag.delivered == 2) && (lag.skipped == 8) && (lag.behind == 0), "lag of the blocked observer");
+    lag = observable.lag(&counting);
+    check((lag.delivered + lag.skipped == 10) && (lag.behind == 0), "lag of an observer kept up");
+    check(counting.updates == 3 + static_cast<int>(lag.delivered), "asynchronous deliveries counted");
+
+    LeavingObserver leavingAsync;
+    observable.addObserver(&leavingAsync);
+    observable.notifyAll();
+    observable.drain();
+    observable.notifyAll();
+    observable.drain();
+    check(leavingAsync.updates == 1, "asynchronous removal from an update");
+
+    // removeObserver() returns once the deliveries in progress are over
+    observable.removeObserver(&blocked);
+    int before = blocked.updates;
+    observable.notifyAll();
+    observable.drain();
+    check(blocked.updates == before, "no update after removal");
+
+    observable.setThreadPool(nullptr);
+    int delivered = counting.updates;
+    observable.notifyAll();
+    check(counting.updates == delivered + 1, "back to synchronous notifications");
+    observable.removeObserver(&counting);
+
+    std::cout << (failures ? "Observable test failed!" : "Observable test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,471 @@
+// Cost of notifications for the producer. Build with -DCMAKE_BUILD_TYPE=Release
+// to get meaningful numbers.
+#include "Observer.h"
+#include "StaticObserver.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stands for an observer doing I/O on every update
+class SlowObserver : public Observer
+{
+public:
+    SlowObserver(WeatherProvider& weather_, std::chrono::microseconds cost_)
+    : weather(weather_)
+    , cost(cost_)
+    {
+        weather.addObserver(this);
+    }
+
+    ~SlowObserver()
+    {
+        weather.removeObserver(this);
+    }
+
+    void update(Observable&) override
+    {
+        lastTemperature = weather.getTemperatureInCelsius();
+        std::this_thread::sleep_for(cost);
+    }
+
+    std::atomic<int> lastTemperature {0}; // read by the producer while updates run
+
+private:
+    WeatherProvider& weather;
+    const std::chrono::microseconds cost;
+};
+
+// Publishes updates as fast as possible, returns the mean time of setWeather()
+double publish(WeatherProvider& weather, int updates)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= updates; ++i)
+        weather.setWeather(i, (i % 3) ? "sunny" : "raining");
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / updates;
+}
+
+// Counts its updates, and those it gets after its removal, which must never happen
+class CountingObserver : public Observer
+{
+public:
+    void update(Observable&) override
+    {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        if (removed.load())
+            lateCalls.fetch_add(1);
+    }
+
+    std::atomic<uint64_t> calls {0};
+    std::atomic<bool> removed {false};
+    std::atomic<uint64_t> lateCalls {0};
+};
+
+// Notifying threads racing with threads adding and removing observers
+void stress(ThreadPool* pool, unsigned notifiers, unsigned churners, std::chrono::milliseconds duration)
+{
+    WeatherProvider weather;
+    weather.setThreadPool(pool);
+    std::atomic<bool> stop {false};
+    std::atomic<uint64_t> notifications {0};
+    std::atomic<uint64_t> registrations {0};
+    std::atomic<uint64_t> lateCalls {0};
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned n = 0; n < notifiers; ++n)
+        {
+            threads.emplace_back([&]
+            {
+                while (!stop.load())
+                {
+                    weather.notifyAll();
+                    notifications.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (unsigned c = 0; c < churners; ++c)
+        {
+            threads.emplace_back([&]
+            {
+                std::deque<CountingObserver> observers; // kept alive to catch late calls
+                while (!stop.load())
+                {
+                    for (int i = 0; i < 8; ++i)
+                        weather.addObserver(&observers.emplace_back());
+                    std::this_thread::yield();
+                    for (size_t i = observers.size() - 8; i < observers.size(); ++i)
+                    {
+                        weather.removeObserver(&observers[i]);
+                        observers[i].removed.store(true);
+                    }
+                    registrations.fetch_add(8, std::memory_order_relaxed);
+                }
+                weather.drain();
+                for (const auto& o : observers)
+                    lateCalls += o.lateCalls.load();
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        stop.store(true);
+    }
+
+    std::cout << "  " << (pool ? "asynchronous" : "synchronous") << ", " << notifiers << " notifiers, " << churners << " churners: "
+              << notifications.load() << " notifications, " << registrations.load() << " observers added and removed, "
+              << lateCalls.load() << " calls after removal" << std::endl;
+}
+
+// Removes itself and registers again from each of its callbacks
+class HoppingObserver : public Observer, public WeatherListener
+{
+public:
+    explicit HoppingObserver(WeatherProvider& weather_)
+    : weather(weather_)
+    {
+        weather.addObserver(this);
+        weather.subscribe(this, ALL_WEATHER_FIELDS);
+    }
+
+    ~HoppingObserver()
+    {
+        weather.removeObserver(this);
+        weather.unsubscribe(this);
+    }
+
+    void update(Observable&) override
+    {
+        if (!hopping.load() || busy.exchange(true))
+            return; // already hopping on another notifier
+        weather.removeObserver(this);
+        weather.addObserver(this);
+        hops.fetch_add(1, std::memory_order_relaxed);
+        busy.store(false);
+    }
+
+    void weatherChanged(const WeatherChange&) override
+    {
+        if (!hopping.load() || busy.exchange(true))
+            return;
+        weather.unsubscribe(this);
+        weather.subscribe(this, ALL_WEATHER_FIELDS);
+        hops.fetch_add(1, std::memory_order_relaxed);
+        busy.store(false);
+    }
+
+    std::atomic<uint64_t> hops {0};
+    std::atomic<bool> hopping {true}; // to stop before destruction, which a hop could undo
+
+private:
+    WeatherProvider& weather;
+    std::atomic<bool> busy {false};
+};
+
+// Notifying threads while observers and listeners register again from their callbacks
+void stressCallbacks(ThreadPool* pool, unsigned notifiers, std::chrono::milliseconds duration)
+{
+    WeatherProvider weather;
+    weather.setThreadPool(pool);
+    std::deque<HoppingObserver> observers;
+    for (int i = 0; i < 8; ++i)
+        observers.emplace_back(weather);
+
+    std::atomic<bool> stop {false};
+    std::atomic<uint64_t> updates {0};
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned n = 0; n < notifiers; ++n)
+        {
+            threads.emplace_back([&, n]
+            {
+                for (int i = 0; !stop.load(); ++i)
+                {
+                    weather.setWeather(static_cast<int>(n) * 1000 + i % 1000, "sunny");
+                    updates.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        stop.store(true);
+    }
+    for (auto& o : observers)
+        o.hopping.store(false);
+    weather.drain();
+
+    uint64_t hops = 0;
+    for (const auto& o : observers)
+        hops += o.hops.load();
+    std::cout << "  " << (pool ? "asynchronous" : "synchronous") << ", " << notifiers << " notifiers: "
+              << updates.load() << " updates, " << hops << " registrations from callbacks" << std::endl;
+}
+
+// Synchronous notifications to observers doing nothing, against a plain vector as before
+void benchmarkNotify(size_t observerCount)
+{
+    WeatherProvider weather;
+    std::vector<CountingObserver> observers(observerCount);
+    std::vector<Observer*> plain;
+    for (auto& o : observers)
+    {
+        weather.addObserver(&o);
+        plain.push_back(&o);
+    }
+
+    const size_t rounds = 20'000'000 / observerCount;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r)
+        for (auto o : plain)
+            o->update(weather);
+    std::chrono::duration<double, std::nano> plainTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r)
+        weather.notifyAll();
+    std::chrono::duration<double, std::nano> snapshotTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << observerCount << " observers: " << snapshotTime.count() / rounds << " ns per notifyAll ("
+              << plainTime.count() / rounds << " ns with a plain vector)" << std::endl;
+}
+
+class CountingListener : public WeatherListener
+{
+public:
+    void weatherChanged(const WeatherChange& change) override
+    {
+        calls++;
+        lastTemperature = change.temperatureCelsius;
+    }
+
+    uint64_t calls {0};
+    int lastTemperature {0};
+};
+
+// Temperature changing every 10 updates and sky every 50, with observers or with subscriptions
+void benchmarkSubscriptions(size_t perGroup, int updates)
+{
+    auto publishSlowly = [updates](WeatherProvider& weather)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < updates; ++i)
+            weather.setWeather(i / 10, (i / 50 % 2) ? "raining" : "sunny");
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / updates;
+    };
+
+    WeatherProvider observed;
+    std::vector<CountingObserver> observers(3 * perGroup);
+    for (auto& o : observers)
+        observed.addObserver(&o);
+    double observersTime = publishSlowly(observed);
+    uint64_t observerCalls = 0;
+    for (const auto& o : observers)
+        observerCalls += o.calls.load();
+
+    WeatherProvider subscribed;
+    std::vector<CountingListener> listeners(3 * perGroup);
+    const uint8_t interests[] = {static_cast<uint8_t>(WEATHER_FIELD::TEMPERATURE), static_cast<uint8_t>(WEATHER_FIELD::SKY), ALL_WEATHER_FIELDS};
+    for (size_t i = 0; i < listeners.size(); ++i)
+        subscribed.subscribe(&listeners[i], interests[i / perGroup]);
+    double listenersTime = publishSlowly(subscribed);
+    uint64_t listenerCalls = 0;
+    for (const auto& l : listeners)
+        listenerCalls += l.calls;
+
+    std::cout << "  " << 3 * perGroup << " observers: " << observerCalls << " calls, " << observersTime << " us per update" << std::endl;
+    std::cout << "  " << perGroup << " listeners each on temperature, sky and both: " << listenerCalls << " calls, "
+              << listenersTime << " us per update" << std::endl;
+    for (auto& l : listeners)
+        subscribed.unsubscribe(&l);
+}
+
+// Readers fetching temperature and sky while a writer updates them, checking they belong together
+template <typename READ>
+void benchmarkReaders(const char* name, unsigned readerCount, READ read)
+{
+    WeatherProvider weather;
+    weather.setWeather(0, "sunny");
+    std::atomic<bool> stop {false};
+    std::atomic<uint64_t> reads {0};
+    std::atomic<uint64_t> inconsistent {0};
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        threads.emplace_back([&]
+        {
+            for (int i = 1; !stop.load(std::memory_order_relaxed); ++i)
+                weather.setWeather(i, (i % 2) ? "raining" : "sunny"); // odd temperatures come with rain
+        });
+        for (unsigned r = 0; r < readerCount; ++r)
+        {
+            threads.emplace_back([&]
+            {
+                uint64_t count = 0;
+                uint64_t wrong = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    auto [temperature, raining] = read(weather);
+                    wrong += (temperature % 2 != 0) != raining;
+                    count++;
+                }
+                reads += count;
+                inconsistent += wrong;
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        stop.store(true);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  " << name << ", " << readerCount << " readers: " << static_cast<uint64_t>(reads.load() / elapsed.count())
+              << " reads/sec, " << inconsistent.load() << " inconsistent" << std::endl;
+}
+
+// The same work for each design: summing the temperatures it is notified of
+class VirtualSum : public Observer
+{
+public:
+    explicit VirtualSum(WeatherProvider& weather_)
+    : weather(weather_)
+    {}
+
+    void update(Observable& updatedObservable) override
+    {
+        if (&updatedObservable == &weather)
+            sum += weather.getTemperatureInCelsius();
+    }
+
+    int64_t sum {0};
+
+private:
+    WeatherProvider& weather;
+};
+
+struct StaticSum
+{
+    void update(const WeatherState& state)
+    {
+        sum += state.temperatureCelsius;
+    }
+
+    int64_t sum {0};
+};
+
+template <typename NOTIFY>
+double notificationsPerSecond(size_t subscriberCount, NOTIFY notify)
+{
+    const size_t rounds = 20'000'000 / subscriberCount;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r)
+        notify(static_cast<int32_t>(r));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return rounds * subscriberCount / elapsed.count();
+}
+
+void benchmarkDispatch(size_t subscriberCount)
+{
+    WeatherProvider weather;
+    weather.setWeather(20, "sunny");
+    std::vector<VirtualSum> virtualSums(subscriberCount, VirtualSum(weather));
+    for (auto& o : virtualSums)
+        weather.addObserver(&o);
+    double observableRate = notificationsPerSecond(subscriberCount, [&](int32_t) { weather.notifyAll(); });
+
+    // Baseline: the classic pattern, a plain vector of observers and a virtual call each
+    std::vector<VirtualSum> plainSums(subscriberCount, VirtualSum(weather));
+    std::vector<Observer*> plainObservers;
+    for (auto& o : plainSums)
+        plainObservers.push_back(&o);
+    double virtualRate = notificationsPerSecond(subscriberCount, [&](int32_t)
+    {
+        for (Observer* o : plainObservers)
+            o->update(weather);
+    });
+
+    std::vector<StaticSum> delegateSums(subscriberCount);
+    DelegateObservable<WeatherState> delegates;
+    for (auto& o : delegateSums)
+        delegates.subscribe([&o](const WeatherState& state) { o.update(state); });
+    double delegateRate = notificationsPerSecond(subscriberCount, [&](int32_t t) { delegates.notifyAll(WeatherState{0, t, 0}); });
+
+    std::vector<StaticSum> staticSums(subscriberCount);
+    StaticObservable<WeatherState, std::vector<StaticSum>> observable(staticSums);
+    double staticRate = notificationsPerSecond(subscriberCount, [&](int32_t t) { observable.notifyAll(WeatherState{0, t, 0}); });
+
+    int64_t check = virtualSums[0].sum + plainSums[0].sum + delegateSums[0].sum + staticSums[0].sum;
+    std::cout << "  " << subscriberCount << " subscribers: virtual " << static_cast<uint64_t>(virtualRate)
+              << ", observable " << static_cast<uint64_t>(observableRate)
+              << ", delegates " << static_cast<uint64_t>(delegateRate) << ", static " << static_cast<uint64_t>(staticRate)
+              << " notifications/sec (checksum " << check << ")" << std::endl;
+}
+
+void report(const char* name, WeatherProvider& weather, SlowObserver& observer)
+{
+    ObserverLag lag = weather.lag(&observer);
+    std::cout << "    " << name << ": " << lag.delivered << " delivered, " << lag.skipped << " skipped, "
+              << lag.behind << " behind, last temperature seen " << observer.lastTemperature << std::endl;
+}
+
+int main()
+{
+    std::cout << "Notify cost:" << std::endl;
+    for (size_t observerCount : {1, 10, 100, 1000})
+        benchmarkNotify(observerCount);
+
+    std::cout << "Dispatch:" << std::endl;
+    for (size_t subscriberCount : {1, 10, 1000})
+        benchmarkDispatch(subscriberCount);
+
+    std::cout << "Field subscriptions, 10000 updates:" << std::endl;
+    benchmarkSubscriptions(1000, 10'000);
+
+    std::cout << "Concurrent readers of the weather:" << std::endl;
+    for (unsigned readers : {1, 4})
+    {
+        benchmarkReaders("getters", readers, [](WeatherProvider& weather)
+        {
+            int temperature = weather.getTemperatureInCelsius();
+            return std::pair{temperature, weather.getSkyStatus() == "raining"};
+        });
+        benchmarkReaders("getState", readers, [](WeatherProvider& weather)
+        {
+            WeatherState state = weather.getState();
+            return std::pair{state.temperatureCelsius, weather.getSkyName(state.sky) == "raining"};
+        });
+    }
+
+    std::cout << "Stress test:" << std::endl;
+    {
+        ThreadPool pool(2);
+        stress(nullptr, 2, 2, std::chrono::milliseconds(500));
+        stress(&pool, 2, 2, std::chrono::milliseconds(500));
+        stressCallbacks(nullptr, 2, std::chrono::milliseconds(500));
+        stressCallbacks(&pool, 2, std::chrono::milliseconds(500));
+    }
+
+    WeatherProvider weather;
+    SlowObserver fast(weather, std::chrono::microseconds(0));
+    SlowObserver slow(weather, std::chrono::microseconds(100));
+    SlowObserver slowest(weather, std::chrono::microseconds(1000));
+
+    std::cout << "Synchronous: " << publish(weather, 200) << " us per update" << std::endl;
+
+    ThreadPool pool(3);
+    weather.setThreadPool(&pool);
+    const int updates = 1'000'000;
+    double latency = publish(weather, updates);
+    std::cout << "Asynchronous: " << latency << " us per update" << std::endl;
+    std::cout << "  when the producer stops:" << std::endl;
+    report("0 us observer", weather, fast);
+    report("100 us observer", weather, slow);
+    report("1 ms observer", weather, slowest);
+
+    weather.drain();
+    std::cout << "  after drain:" << std::endl;
+    report("0 us observer", weather, fast);
+    report("100 us observer", weather, slow);
+    report("1 ms observer", weather, slowest);
+}
@@ -0,0 +1,86 @@
+// Checks that SeqLock readers never see a value torn by the writer
+#include "Observer.h"
+#include "SeqLock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Spans several words and ends with a partial one; every field holds the same counter
+struct Sample
+{
+    uint64_t a;
+    uint32_t b;
+    uint64_t c;
+    uint16_t d;
+};
+
+int main()
+{
+    SeqLock<Sample> lock;
+    Sample initial = lock.load();
+    check((initial.a == 0) && (initial.b == 0) && (initial.c == 0) && (initial.d == 0), "value initialized");
+    lock.store(Sample{7, 7, 7, 7});
+    check(lock.load().c == 7, "value stored");
+
+    constexpr uint64_t WRITES = 200000;
+    std::atomic<bool> stop {false};
+    std::atomic<bool> consistent {true};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t)
+        readers.emplace_back([&]
+        {
+            uint64_t last = 0;
+            while (!stop)
+            {
+                Sample s = lock.load();
+                if ((s.b != static_cast<uint32_t>(s.a)) || (s.c != s.a) || (s.d != static_cast<uint16_t>(s.a)) || (s.a < last))
+                    consistent = false;
+                last = s.a;
+            }
+        });
+    for (uint64_t i = 8; i < WRITES; ++i)
+        lock.store(Sample{i, static_cast<uint32_t>(i), i, static_cast<uint16_t>(i)});
+    stop = true;
+    for (auto& t : readers)
+        t.join();
+    check(consistent, "readers see whole values, in order");
+    check(lock.load().a == WRITES - 1, "last value");
+
+    // the weather state is published the same way
+    WeatherProvider weather;
+    stop = false;
+    std::thread reader([&]
+    {
+        while (!stop)
+        {
+            WeatherState state = weather.getState();
+            if ((state.version > 0) && (state.temperatureCelsius != static_cast<int32_t>(state.version)))
+                consistent = false;
+            if ((state.version > 0) && (weather.getSkyName(state.sky) != ((state.version % 2) ? "odd" : "even")))
+                consistent = false;
+        }
+    });
+    for (int i = 1; i <= 2000; ++i)
+        weather.setWeather(i, (i % 2) ? "odd" : "even");
+    stop = true;
+    reader.join();
+    check(consistent, "weather state consistent");
+
+    std::cout << (failures ? "Sequence lock test failed!" : "Sequence lock test passed!") << std::endl;
+    return failures ? 1 : 0;
+}
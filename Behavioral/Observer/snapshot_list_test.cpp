@@ -0,0 +1,101 @@
+// Checks the snapshots of SnapshotList, and their reclamation under concurrent readers
+#include "SnapshotList.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+std::vector<int> contents(const SnapshotList<int>& list)
+{
+    std::vector<int> values;
+    for (int v : list.read())
+        values.push_back(v);
+    return values;
+}
+
+int main()
+{
+    SnapshotList<int> list;
+    check(list.read().size() == 0, "empty list");
+    check(!list.removeIf([](int) { return true; }), "nothing removed from an empty list");
+    for (int i = 0; i < 4; ++i)
+        list.add(i);
+    list.add(2);
+    check(list.removeIf([](int v) { return v == 2; }), "removal");
+    check((contents(list) == std::vector<int>{0, 1, 3, 2}), "first match removed only");
+
+    {
+        auto guard = list.read();
+        list.removeIf([](int v) { return v == 0; });
+        list.add(9);
+        std::vector<int> seen(guard.begin(), guard.end());
+        check((seen == std::vector<int>{0, 1, 3, 2}), "snapshot unchanged by writers");
+        check((contents(list) == std::vector<int>{1, 3, 2, 9}), "nested read sees the new list");
+        check(!list.synchronize(), "synchronize refused during a read");
+    }
+    check(list.synchronize(), "synchronize outside of reads");
+
+    // synchronize() waits for the reader holding the removed element
+    std::promise<void> reading;
+    std::promise<void> release;
+    std::atomic<bool> released {false};
+    std::thread reader([&]
+    {
+        auto guard = list.read();
+        reading.set_value();
+        release.get_future().wait();
+        released = true;
+    });
+    reading.get_future().wait();
+    list.removeIf([](int v) { return v == 9; });
+    auto synchronized = std::async(std::launch::async, [&] { return list.synchronize(); });
+    check(synchronized.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout, "synchronize blocked by a reader");
+    release.set_value();
+    check(synchronized.get() && released, "synchronize returns once the reader left");
+    reader.join();
+
+    // readers check every element they see is alive while writers replace them
+    SnapshotList<std::shared_ptr<int>> shared;
+    std::atomic<bool> stop {false};
+    std::atomic<bool> consistent {true};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t)
+        readers.emplace_back([&]
+        {
+            while (!stop)
+                for (const auto& p : shared.read())
+                    if (*p != 42)
+                        consistent = false;
+        });
+    for (int i = 0; i < 2000; ++i)
+    {
+        shared.add(std::make_shared<int>(42));
+        if (i % 3 != 0)
+            shared.removeIf([](const std::shared_ptr<int>&) { return true; });
+        if (i % 100 == 0)
+            shared.synchronize();
+    }
+    stop = true;
+    for (auto& t : readers)
+        t.join();
+    check(consistent, "readers only see live elements");
+    check(shared.read().size() == 667, "elements left");
+
+    std::cout << (failures ? "Snapshot list test failed!" : "Snapshot list test passed!") << std::endl;
+    return failures ? 1 : 0;
+}